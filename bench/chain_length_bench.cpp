@@ -0,0 +1,57 @@
+#include "src.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+// bucket chain lengths of the chained hashmap under modulo_hashing
+// (hash % n) and mix_hashing (power of two + splitmix64), for
+// sequential, strided and random keys
+
+template<class Hashing>
+void report(const std::string &name, const std::string &keys, const std::vector<int> &key){
+    using mp = sjtu::hashmap<int,int,std::hash<int>,std::equal_to<int>,sjtu::basic_chained_table<Hashing>>;
+    mp map;
+    for(size_t i = 0; i < key.size(); i++)
+        map.insert(sjtu::pair<int,int>(key[i], int(i)));
+    size_t hist[6] = {0, 0, 0, 0, 0, 0}, longest = 0;
+    double probes = 0;
+    for(size_t i = 0; i < map.bucket.size(); i++) {
+        size_t len = map.bucket[i] ? map.bucket[i]->size() : 0;
+        hist[len < 5 ? len : 5]++;
+        longest = std::max(longest, len);
+        probes += len * (len + 1) / 2.0;
+    }
+    std::cout << std::left << std::setw(8) << name << std::setw(12) << keys
+              << std::right << std::setw(9) << map.bucket.size()
+              << std::setw(8) << longest
+              << std::setw(10) << std::fixed << std::setprecision(2) << probes / map.size;
+    for(int i = 0; i < 6; i++)
+        std::cout << std::setw(8) << std::setprecision(1) << 100.0 * hist[i] / map.bucket.size() << "%";
+    std::cout << std::endl;
+}
+
+int main(){
+    const int n = 100000;
+    std::vector<int> sequential, strided, random;
+    std::mt19937 rng(2024);
+    for(int i = 0; i < n; i++) {
+        sequential.push_back(i);
+        strided.push_back(i * 1024);
+        random.push_back(int(rng() >> 1));
+    }
+    std::cout << std::left << std::setw(8) << "policy" << std::setw(12) << "keys"
+              << std::right << std::setw(9) << "buckets" << std::setw(8) << "max"
+              << std::setw(10) << "probe/hit";
+    for(int i = 0; i < 6; i++)
+        std::cout << std::setw(8) << "len=" + std::to_string(i) + (i == 5 ? "+" : "") << " ";
+    std::cout << std::endl;
+    report<sjtu::modulo_hashing>("modulo", "sequential", sequential);
+    report<sjtu::mix_hashing>("mix", "sequential", sequential);
+    report<sjtu::modulo_hashing>("modulo", "stride 1024", strided);
+    report<sjtu::mix_hashing>("mix", "stride 1024", strided);
+    report<sjtu::modulo_hashing>("modulo", "random", random);
+    report<sjtu::mix_hashing>("mix", "random", random);
+}
@@ -0,0 +1,79 @@
+#include "src.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <type_traits>
+
+// linked_hashmap with pointer nodes (chained_table) against the
+// arena with 32-bit links (compact_table): link bytes per entry,
+// walking the order from the eviction end, and lru hits/evictions
+
+using clock_type = std::chrono::steady_clock;
+
+double ns_since(clock_type::time_point t, long long ops){
+    return std::chrono::duration<double, std::nano>(clock_type::now() - t).count() / ops;
+}
+
+template<class Table, class Map>
+double bucket_bytes(const Map &map){
+    if constexpr (std::is_same<Table, sjtu::compact_table>::value)
+        return sizeof(map.bucket[0]) * double(map.bucket.size());
+    else
+        return sizeof(map.index.bucket[0]) * double(map.index.bucket.size());
+}
+
+template<class Table>
+void run(const std::string &name, int n){
+    using map_type = sjtu::linked_hashmap<int,int,std::hash<int>,std::equal_to<int>,Table>;
+    using node_type = typename map_type::Node;
+    map_type probe;
+    for(int i = 0; i < n; i++)
+        probe.insert(sjtu::pair<const int,int>(i, i));
+    // links in the node plus the bucket slots, per element
+    double link_bytes = sizeof(node_type) - sizeof(sjtu::pair<const int,int>)
+                      + bucket_bytes<Table>(probe) / n;
+
+    sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,Table> cache(n);
+    unsigned x = 1;
+    for(int i = 0; i < n; i++) {
+        x = x * 1103515245 + 12345;
+        cache.save(sjtu::pair<const int,int>(int(x >> 1), i));
+    }
+    // the order is now scattered over the heap/arena, walk it
+    auto t = clock_type::now();
+    long long sum = 0;
+    for(int round = 0; round < 10; round++)
+        for(auto it = cache.map.begin(); it != cache.map.end(); ++it)
+            sum += it->second;
+    double walk = ns_since(t, 10ll * n);
+    // hits on random cached keys
+    std::vector<int> keys;
+    for(auto it = cache.map.begin(); it != cache.map.end(); ++it)
+        keys.push_back(it->first);
+    t = clock_type::now();
+    const int ops = 4000000;
+    for(int i = 0; i < ops; i++) {
+        x = x * 1103515245 + 12345;
+        sum += *cache.get(keys[(x >> 4) % keys.size()]);
+    }
+    double hit = ns_since(t, ops);
+    // saves of new keys, each evicts the oldest
+    t = clock_type::now();
+    for(int i = 0; i < ops; i++)
+        cache.save(sjtu::pair<const int,int>(-1 - i, i));
+    double evict = ns_since(t, ops);
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << link_bytes << std::setw(12) << walk
+              << std::setw(12) << hit << std::setw(12) << evict << "   (" << sum % 10 << ")" << std::endl;
+}
+
+int main(){
+    std::cout << std::left << std::setw(16) << "n = 1M" << std::right
+              << std::setw(12) << "link B/elt" << std::setw(12) << "walk ns"
+              << std::setw(12) << "get hit ns" << std::setw(12) << "evict ns" << std::endl;
+    const int n = 1000000;
+    run<sjtu::chained_table>("chained_table", n);
+    run<sjtu::compact_table>("compact_table", n);
+}
@@ -0,0 +1,77 @@
+#include "concurrent_hashmap.hpp"
+#include "src.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <shared_mutex>
+#include <chrono>
+#include <cstdlib>
+
+// lookups only, from 1 to N threads (doubling, N = 64 or the first
+// argument), on 1M <int,int> keys (half of the looked up keys are
+// missing): hashmap behind a std::shared_mutex (readers still write
+// the lock's counter) against the lock-free concurrent_hashmap, whose
+// readers write nothing shared but their own epoch record. the
+// scaling columns are the throughput over that of one thread.
+//     g++ -std=c++17 -O2 -pthread -I../lru concurrent_read_bench.cpp
+//     ./a.out 16
+
+struct locked_hashmap{
+    std::shared_mutex lock;
+    sjtu::hashmap<int,int> map;
+    bool find(int key, int &out){
+        std::shared_lock<std::shared_mutex> guard(lock);
+        auto it = map.find(key);
+        if(it == map.end())
+            return false;
+        out = it->second;
+        return true;
+    }
+};
+
+template<class Map>
+double run(Map &map, int threads, int ops_per_thread, int key_range){
+    std::vector<std::thread> workers;
+    std::vector<long long> found(threads);
+    auto start = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; t++)
+        workers.emplace_back([&map, &found, t, ops_per_thread, key_range](){
+            unsigned x = 12345 + t * 7919;
+            int out;
+            for(int i = 0; i < ops_per_thread; i++) {
+                x = x * 1103515245 + 12345;
+                found[t] += map.find(int((x >> 2) % key_range), out);
+            }
+        });
+    for(auto &w : workers)
+        w.join();
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return double(threads) * ops_per_thread / s / 1e6;
+}
+
+int main(int argc, char **argv){
+    const int size = 1000000, key_range = 2 * size, total_ops = 8000000;
+    const int max_threads = argc > 1 ? std::atoi(argv[1]) : 64;
+    locked_hashmap locked;
+    sjtu::concurrent_hashmap<int,int> lock_free;
+    for(int i = 0; i < size; i++) {
+        locked.map.insert(sjtu::pair<const int,int>(i, i));
+        lock_free.insert(sjtu::pair<const int,int>(i, i));
+    }
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(20) << "shared_mutex Mops/s" << std::setw(10) << "scaling"
+              << std::setw(20) << "lock-free Mops/s" << std::setw(10) << "scaling" << std::endl;
+    double l1 = 0, f1 = 0;
+    for(int threads = 1; threads <= max_threads; threads *= 2) {
+        double l = run(locked, threads, total_ops / threads, key_range);
+        double f = run(lock_free, threads, total_ops / threads, key_range);
+        if(threads == 1) {
+            l1 = l;
+            f1 = f;
+        }
+        std::cout << std::fixed << std::setprecision(2) << std::setw(8) << threads
+                  << std::setw(20) << l << std::setw(10) << l / l1
+                  << std::setw(20) << f << std::setw(10) << f / f1 << std::endl;
+    }
+}
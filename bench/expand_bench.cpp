@@ -0,0 +1,49 @@
+#include "src.hpp"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+
+// grow a hashmap<Integer,Matrix<int>> to 1M entries from empty,
+// every expand() along the way relinks the nodes it moves.
+// peak RSS is per process, so one table per run:
+//     ./expand_bench [chained|incremental]
+
+static size_t allocations = 0;
+void *operator new(size_t n){
+    allocations++;
+    if(void *p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+template<class Table>
+void grow(const std::string &name, int n){
+    using value_type = sjtu::pair<const Integer,Matrix<int> >;
+    sjtu::hashmap<Integer,Matrix<int>,Hash,Equal,Table> map;
+    auto start = std::chrono::steady_clock::now();
+    size_t before = allocations;
+    for(int i = 0; i < n; i++)
+        map.insert(value_type(Integer(i), Matrix<int>(4, 4, i)));
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t allocs = allocations - before;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << name << ": " << n << " entries, " << map.bucket.size() << " buckets" << std::endl;
+    std::cout << "  total time     " << ms << " ms" << std::endl;
+    std::cout << "  peak RSS       " << usage.ru_maxrss / 1024 << " MB" << std::endl;
+    std::cout << "  allocs/insert  " << double(allocs) / n << std::endl;
+}
+
+int main(int argc, char **argv){
+    std::string which = argc > 1 ? argv[1] : "chained";
+    const int n = 1000000;
+    if(which == "incremental")
+        grow<sjtu::incremental_chained_table>("hashmap incremental", n);
+    else
+        grow<sjtu::chained_table>("hashmap chained", n);
+}
@@ -0,0 +1,90 @@
+#include "src.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+
+// compare the chained hashmap with the open addressing ones
+// on the types used by test/1.cpp and test/2.cpp
+
+double now_ms(){
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void report(const std::string &name, const std::string &phase, int n, double ms){
+    std::cout << std::left << std::setw(30) << name << std::setw(10) << phase
+              << std::right << std::setw(10) << std::fixed << std::setprecision(2) << ms << " ms"
+              << std::setw(10) << std::setprecision(1) << ms * 1e6 / n << " ns/op" << std::endl;
+}
+
+template<class Key, class mp, class Make>
+void run(const std::string &name, int n, Make make){
+    using value_type = typename mp::value_type;
+    mp map;
+    long long sum = 0;
+    double t = now_ms();
+    for(int i = 0; i < n; i++)
+        map.insert(value_type(Key(i), make(i)));
+    report(name, "insert", n, now_ms() - t);
+
+    t = now_ms();
+    for(int i = 0; i < n; i++)
+        sum += map.find(Key(i)) != map.end();
+    report(name, "find hit", n, now_ms() - t);
+
+    t = now_ms();
+    for(int i = n; i < 2 * n; i++)
+        sum += map.find(Key(i)) != map.end();
+    report(name, "find miss", n, now_ms() - t);
+
+    t = now_ms();
+    for(int i = 0; i < n; i++)
+        sum += map.remove(Key(i));
+    report(name, "remove", n, now_ms() - t);
+    if(sum != 2 * n)
+        std::cout << "   error." << std::endl;
+}
+
+// Equal which counts how often it is called
+struct counting_equal{
+    static long long calls;
+    bool operator()(int a, int b) const {
+        calls++;
+        return a == b;
+    }
+};
+long long counting_equal::calls = 0;
+
+template<class mp>
+void miss_compares(const std::string &name, int n){
+    mp map;
+    for(int i = 0; i < n; i++)
+        map.insert(sjtu::pair<int,int>(i * 7, i));
+    counting_equal::calls = 0;
+    long long found = 0;
+    for(int i = 0; i < n; i++)
+        found += map.find(i * 7 + 3) != map.end();
+    std::cout << std::left << std::setw(30) << name << std::setw(10) << "miss"
+              << std::right << std::setw(10) << std::fixed << std::setprecision(3)
+              << double(counting_equal::calls) / n << " Equal calls/op" << std::endl;
+    if(found)
+        std::cout << "   error." << std::endl;
+}
+
+int main(){
+    const int n = 1000000;
+    auto make_int = [](int i){ return i; };
+    run<int, sjtu::hashmap<int,int>>("<int,int> chained", n, make_int);
+    run<int, sjtu::hashmap<int,int,std::hash<int>,std::equal_to<int>,sjtu::robin_hood_table>>("<int,int> robin hood", n, make_int);
+    run<int, sjtu::hashmap<int,int,std::hash<int>,std::equal_to<int>,sjtu::swiss_table>>("<int,int> swiss", n, make_int);
+
+    const int m = 200000;
+    auto make_matrix = [](int i){ return Matrix<int>(2, 2, i); };
+    run<Integer, sjtu::hashmap<Integer,Matrix<int>,Hash,Equal>>("<Integer,Matrix> chained", m, make_matrix);
+    run<Integer, sjtu::hashmap<Integer,Matrix<int>,Hash,Equal,sjtu::robin_hood_table>>("<Integer,Matrix> robin hood", m, make_matrix);
+    run<Integer, sjtu::hashmap<Integer,Matrix<int>,Hash,Equal,sjtu::swiss_table>>("<Integer,Matrix> swiss", m, make_matrix);
+
+    miss_compares<sjtu::hashmap<int,int,std::hash<int>,counting_equal>>("<int,int> chained", n);
+    miss_compares<sjtu::hashmap<int,int,std::hash<int>,counting_equal,sjtu::robin_hood_table>>("<int,int> robin hood", n);
+    miss_compares<sjtu::hashmap<int,int,std::hash<int>,counting_equal,sjtu::swiss_table>>("<int,int> swiss", n);
+}
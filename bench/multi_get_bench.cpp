@@ -0,0 +1,67 @@
+#include "src.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+
+// ns per key of basic_lru<int,int>::get called in a loop against
+// multi_get (hashes first, prefetches interleaved) on batches of 32
+// and 256 random keys, all hits, for tables from cache sized to far
+// beyond the last level cache; then the same for save / multi_save
+// of present keys.
+//     g++ -std=c++17 -O2 -I../lru multi_get_bench.cpp
+
+using cache = sjtu::basic_lru<int,int>;
+using value_type = sjtu::pair<const int,int>;
+
+template<class F>
+double ns_per_key(F f, size_t keys){
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / keys;
+}
+
+int main(){
+    const size_t lookups = 4000000;
+    std::cout << std::setw(10) << "size" << std::setw(7) << "batch" << std::setw(10) << "get" << std::setw(11) << "multi_get"
+              << std::setw(10) << "save" << std::setw(12) << "multi_save" << "   (ns/key)" << std::endl;
+    for(size_t size : {1u << 16, 1u << 20, 1u << 23}) {
+        cache memory(size);
+        for(size_t i = 0; i < size; i++)
+            memory.save(value_type(int(i), int(i)));
+        std::vector<int> keys(lookups);
+        std::vector<value_type> values;
+        unsigned x = 12345;
+        for(size_t i = 0; i < lookups; i++) {
+            x = x * 1103515245 + 12345;
+            keys[i] = int(((unsigned long long)x << 7 ^ x >> 9) % size);
+            values.emplace_back(keys[i], int(i));
+        }
+        for(size_t batch : {32, 256}) {
+            std::vector<int *> out(batch);
+            long long sum = 0;
+            double g = ns_per_key([&](){
+                for(size_t i = 0; i < lookups; i += batch)
+                    for(size_t j = 0; j < batch; j++)
+                        out[j] = memory.get(keys[i + j]);
+                sum += *out[0];
+            }, lookups);
+            double mg = ns_per_key([&](){
+                for(size_t i = 0; i < lookups; i += batch)
+                    memory.multi_get(keys.data() + i, batch, out.data());
+                sum += *out[0];
+            }, lookups);
+            double s = ns_per_key([&](){
+                for(size_t i = 0; i < lookups; i++)
+                    memory.save(values[i]);
+            }, lookups);
+            double ms = ns_per_key([&](){
+                for(size_t i = 0; i < lookups; i += batch)
+                    memory.multi_save(values.data() + i, batch);
+            }, lookups);
+            std::cout << std::fixed << std::setprecision(1) << std::setw(10) << size << std::setw(7) << batch
+                      << std::setw(10) << g << std::setw(11) << mg << std::setw(10) << s << std::setw(12) << ms
+                      << (sum == 42 ? " " : "") << std::endl;
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#include "src.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+
+// hit ratio and Mops/s of every eviction policy on the same traces:
+// each access is a get, and a miss saves the key (a read-through
+// cache). the traces are 4M accesses over 1M keys with the cache
+// holding 1% or 10% of them:
+//   zipf    zipfian, s = 0.99
+//   loop    zipf with every 10th access from a cyclic scan over all
+//           keys (one-hit wonders that should not flush hot keys)
+//   scan    zipf, but the last 30% of every 100K accesses is a burst
+//           of keys never seen before nor again
+//   uniform every key equally likely
+// a new policy only needs a line in main. last, the cost of the
+// tinylfu frequency sketch on its own.
+//     g++ -std=c++17 -O2 -I../lru policy_bench.cpp
+
+struct trace{
+    std::string name;
+    std::vector<int> keys;
+};
+
+unsigned next_random(unsigned long long &x){
+    x = x * 6364136223846793005ull + 1442695040888963407ull;
+    return unsigned(x >> 33);
+}
+
+/**
+ * zipf over [0, n) by inverting the cumulative distribution
+ */
+std::vector<int> zipf_keys(int n, double s, size_t count, unsigned long long seed){
+    std::vector<double> cdf(n);
+    double sum = 0;
+    for(int i = 0; i < n; i++)
+        cdf[i] = sum += 1 / std::pow(i + 1.0, s);
+    std::vector<int> keys(count);
+    for(size_t i = 0; i < count; i++) {
+        double u = next_random(seed) / 2147483648.0 * sum;
+        int rank = int(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+        // scatter the ranks so hot keys are not neighbours
+        keys[i] = int((rank * 2654435761u) % unsigned(n));
+    }
+    return keys;
+}
+
+std::vector<trace> make_traces(int n, size_t count){
+    std::vector<trace> traces;
+    traces.push_back({"zipf", zipf_keys(n, 0.99, count, 1)});
+    trace loop{"loop", zipf_keys(n, 0.99, count, 2)};
+    for(size_t i = 0; i < count; i += 10)
+        loop.keys[i] = int((i / 10) % n);
+    traces.push_back(loop);
+    trace scan{"scan", zipf_keys(n, 0.99, count, 4)};
+    for(size_t i = 0; i < count; i++)
+        if(i % 100000 >= 70000)
+            scan.keys[i] = n + int(i);
+    traces.push_back(scan);
+    trace uniform{"uniform", std::vector<int>(count)};
+    unsigned long long seed = 3;
+    for(size_t i = 0; i < count; i++)
+        uniform.keys[i] = int(next_random(seed) % n);
+    traces.push_back(uniform);
+    return traces;
+}
+
+template<class Policy>
+void run(const std::string &name, const std::vector<trace> &traces, int capacity){
+    std::cout << std::setw(10) << name;
+    for(const trace &t : traces) {
+        sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,Policy> cache(capacity);
+        size_t hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for(int key : t.keys) {
+            if(cache.get(key))
+                hits++;
+            else
+                cache.save(sjtu::pair<const int,int>(key, key));
+        }
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(2) << std::setw(10) << 100.0 * hits / t.keys.size()
+                  << std::setw(8) << t.keys.size() / s / 1e6;
+    }
+    std::cout << std::endl;
+}
+
+int main(){
+    const int keys = 1000000;
+    const size_t accesses = 4000000;
+    std::vector<trace> traces = make_traces(keys, accesses);
+    for(int capacity : {keys / 100, keys / 10}) {
+        std::cout << "capacity " << capacity << " (hit % / Mops/s)" << std::endl << std::setw(10) << "policy";
+        for(const trace &t : traces)
+            std::cout << std::setw(18) << t.name;
+        std::cout << std::endl;
+        run<sjtu::lru_policy>("lru", traces, capacity);
+        run<sjtu::fifo_policy>("fifo", traces, capacity);
+        run<sjtu::random_policy>("random", traces, capacity);
+        run<sjtu::slru_policy>("slru", traces, capacity);
+        run<sjtu::tinylfu_policy>("tinylfu", traces, capacity);
+        run<sjtu::arc_policy>("arc", traces, capacity);
+        run<sjtu::clock_policy>("clock", traces, capacity);
+        run<sjtu::clock_pro_policy>("clock_pro", traces, capacity);
+        run<sjtu::s3fifo_policy>("s3fifo", traces, capacity);
+    }
+    // the cost of tinylfu's sketch alone, sized for 100K elements
+    sjtu::frequency_sketch sketch;
+    sketch.ensure_capacity(keys / 10);
+    const std::vector<int> &zipf = traces[0].keys;
+    auto start = std::chrono::steady_clock::now();
+    for(int key : zipf)
+        sketch.increment(size_t(key));
+    double increment = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / zipf.size();
+    unsigned sum = 0;
+    start = std::chrono::steady_clock::now();
+    for(int key : zipf)
+        sum += sketch.frequency(size_t(key));
+    double frequency = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / zipf.size();
+    std::cout << std::fixed << std::setprecision(1) << "frequency_sketch: " << increment << " ns/increment, "
+              << frequency << " ns/frequency" << (sum ? "" : " ") << std::endl;
+}
@@ -0,0 +1,62 @@
+#include "src.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+// per-insert latency while the table grows, with the whole-table
+// expand() and with the incremental (Redis dict style) rehash
+
+using clock_type = std::chrono::steady_clock;
+
+void report(const std::string &name, std::vector<long long> &ns){
+    long long total = 0;
+    for(size_t i = 0; i < ns.size(); i++)
+        total += ns[i];
+    std::sort(ns.begin(), ns.end());
+    auto at = [&](double q){ return ns[std::min(ns.size() - 1, size_t(q * ns.size()))]; };
+    std::cout << std::left << std::setw(36) << name << std::right
+              << std::setw(10) << total / 1000000 << " ms"
+              << std::setw(8) << at(0.5) << std::setw(8) << at(0.99)
+              << std::setw(9) << at(0.999) << std::setw(12) << ns.back() << std::endl;
+}
+
+template<class Table>
+void hashmap_inserts(const std::string &name, int n){
+    sjtu::hashmap<int,int,std::hash<int>,std::equal_to<int>,Table> map;
+    std::vector<long long> ns(n);
+    for(int i = 0; i < n; i++) {
+        auto t = clock_type::now();
+        map.insert(sjtu::pair<int,int>(i, i));
+        ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - t).count();
+    }
+    report(name, ns);
+}
+
+template<class Table>
+void lru_saves(const std::string &name, int n){
+    using value_type = sjtu::pair<Integer,Matrix<int> >;
+    sjtu::basic_lru<Integer,Matrix<int>,Hash,Equal,Table> cache(n);
+    std::vector<long long> ns(n);
+    for(int i = 0; i < n; i++) {
+        value_type v(Integer(i), Matrix<int>(2, 2, i));
+        auto t = clock_type::now();
+        cache.save(v);
+        ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - t).count();
+    }
+    report(name, ns);
+}
+
+int main(){
+    std::cout << std::left << std::setw(36) << "ns per insert" << std::right
+              << std::setw(13) << "total" << std::setw(8) << "p50" << std::setw(8) << "p99"
+              << std::setw(9) << "p99.9" << std::setw(12) << "max" << std::endl;
+    const int n = 4000000;
+    hashmap_inserts<sjtu::chained_table>("hashmap<int,int> expand()", n);
+    hashmap_inserts<sjtu::incremental_chained_table>("hashmap<int,int> incremental", n);
+    const int m = 2000000;
+    lru_saves<sjtu::chained_table>("lru save expand()", m);
+    lru_saves<sjtu::incremental_chained_table>("lru save incremental", m);
+}
@@ -0,0 +1,70 @@
+#include "src.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// lru::save on a full cache: every new key evicts the oldest one.
+// "probe per step" replays what save did before insert_or_assign
+// (count, find + remove, begin + remove, insert) on the same map.
+
+template<class Cache, class V>
+void probe_per_step(Cache &cache, const V &v){
+    if(cache.map.count(v.first))
+        cache.map.remove(cache.map.find(v.first));
+    if(cache.map.size() >= cache.c)
+        cache.map.remove(cache.map.begin());
+    cache.map.insert(v);
+}
+template<class Cache, class V>
+void current(Cache &cache, const V &v){
+    cache.save(v);
+}
+
+Matrix<int> make_value(Integer *, int i){ return Matrix<int>(4, 4, i); }
+int make_value(int *, int i){ return i; }
+
+template<class Key, class T, class Hash, class Equal, bool Current>
+void run(const std::string &name, int capacity, int key_range, int ops){
+    using cache_type = sjtu::basic_lru<Key,T,Hash,Equal>;
+    using value_type = sjtu::pair<const Key,T>;
+    cache_type cache(capacity);
+    // a ring of prebuilt values with random keys, much longer than the
+    // cache, so the evicting runs don't come back to a cached key
+    const int ring = 1 << 17;
+    std::vector<value_type> values;
+    unsigned x = 12345;
+    for(int i = 0; i < ring; i++) {
+        x = x * 1103515245 + 12345;
+        values.push_back(value_type(Key((x >> 4) % key_range), make_value((Key *)nullptr, i)));
+    }
+    for(int i = 0; i < capacity; i++)
+        cache.save(value_type(Key(i), make_value((Key *)nullptr, i)));
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < ops; i++) {
+        if(Current)
+            current(cache, values[i & (ring - 1)]);
+        else
+            probe_per_step(cache, values[i & (ring - 1)]);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(8)
+              << std::fixed << std::setprecision(1) << ns / ops << " ns/save" << std::endl;
+}
+
+int main(){
+    const int capacity = 10000, ops = 4000000;
+    // key_range == capacity: every key is cached, all updates
+    // key_range 100x capacity: almost every save evicts
+    run<Integer,Matrix<int>,Hash,Equal,true>("lru updates, insert_or_assign", capacity, capacity, ops);
+    run<Integer,Matrix<int>,Hash,Equal,false>("lru updates, probe per step", capacity, capacity, ops);
+    run<Integer,Matrix<int>,Hash,Equal,true>("lru evicting, insert_or_assign", capacity, capacity * 100, ops);
+    run<Integer,Matrix<int>,Hash,Equal,false>("lru evicting, probe per step", capacity, capacity * 100, ops);
+    using H = std::hash<int>;
+    using E = std::equal_to<int>;
+    run<int,int,H,E,true>("basic_lru<int,int> updates, insert_or_assign", capacity, capacity, ops);
+    run<int,int,H,E,false>("basic_lru<int,int> updates, probe per step", capacity, capacity, ops);
+    run<int,int,H,E,true>("basic_lru<int,int> evicting, insert_or_assign", capacity, capacity * 100, ops);
+    run<int,int,H,E,false>("basic_lru<int,int> evicting, probe per step", capacity, capacity * 100, ops);
+}
@@ -0,0 +1,84 @@
+#include "sharded_lru.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+
+// 90% get / 10% save from 1 to 64 threads: one lru behind a global
+// mutex against sharded_lru with 64 shards, with the shard lock taken
+// on every hit, with read buffers (hits share the shard lock) and with
+// clock_policy (hits share the lock and only set a reference bit).
+// all of them copy the value out on a hit, as a caller of a shared
+// cache has to.
+//     g++ -std=c++17 -O2 -pthread -I../lru sharded_bench.cpp
+
+using value_type = sjtu::pair<const Integer,Matrix<int> >;
+
+struct global_lock_lru{
+    std::mutex lock;
+    sjtu::lru memory;
+    global_lock_lru(int size):memory(size){}
+    void save(const value_type &v){
+        std::lock_guard<std::mutex> guard(lock);
+        memory.save(v);
+    }
+    bool get(const Integer &key, Matrix<int> &out){
+        std::lock_guard<std::mutex> guard(lock);
+        Matrix<int> *value = memory.get(key);
+        if(!value)
+            return false;
+        out = *value;
+        return true;
+    }
+};
+
+template<class Cache>
+double run(Cache &cache, int threads, int ops_per_thread, int key_range){
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; t++)
+        workers.emplace_back([&cache, t, ops_per_thread, key_range](){
+            unsigned x = 12345 + t * 7919;
+            Matrix<int> out;
+            for(int i = 0; i < ops_per_thread; i++) {
+                x = x * 1103515245 + 12345;
+                int key = (x >> 4) % key_range;
+                if((x >> 28) < 15)
+                    cache.get(Integer(key), out);
+                else
+                    cache.save(value_type(Integer(key), Matrix<int>(2, 2, key)));
+            }
+        });
+    for(auto &w : workers)
+        w.join();
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return double(threads) * ops_per_thread / s / 1e6;
+}
+
+int main(){
+    const int capacity = 100000, key_range = 2 * capacity, total_ops = 4000000;
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "global Mops/s" << std::setw(16) << "sharded Mops/s"
+              << std::setw(16) << "buffered Mops/s" << std::setw(16) << "clock Mops/s" << std::endl;
+    for(int threads = 1; threads <= 64; threads *= 2) {
+        global_lock_lru global(capacity);
+        sjtu::sharded_lru<Integer,Matrix<int>,Hash,Equal,64> sharded(capacity);
+        sjtu::sharded_lru<Integer,Matrix<int>,Hash,Equal,64,sjtu::chained_table,true> buffered(capacity);
+        sjtu::sharded_lru<Integer,Matrix<int>,Hash,Equal,64,sjtu::chained_table,true,sjtu::clock_policy> clock(capacity);
+        for(int i = 0; i < capacity; i++) {
+            global.save(value_type(Integer(i), Matrix<int>(2, 2, i)));
+            sharded.save(value_type(Integer(i), Matrix<int>(2, 2, i)));
+            buffered.save(value_type(Integer(i), Matrix<int>(2, 2, i)));
+            clock.save(value_type(Integer(i), Matrix<int>(2, 2, i)));
+        }
+        double g = run(global, threads, total_ops / threads, key_range);
+        double s = run(sharded, threads, total_ops / threads, key_range);
+        double b = run(buffered, threads, total_ops / threads, key_range);
+        double k = run(clock, threads, total_ops / threads, key_range);
+        std::cout << std::fixed << std::setprecision(2) << std::setw(8) << threads
+                  << std::setw(16) << g << std::setw(16) << s << std::setw(16) << b << std::setw(16) << k << std::endl;
+    }
+}
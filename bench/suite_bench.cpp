@@ -0,0 +1,377 @@
+#ifdef SJTU_BENCH_VECTORVERSION
+#include "lru_vectorversion.hpp"
+#define SJTU_BENCH_IMPL "lru_vectorversion.hpp"
+#else
+#include "src.hpp"
+#define SJTU_BENCH_IMPL "lru.hpp"
+#endif
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// every container of the header under test, case by case: double_list
+// (insert at either end, erase, iterate), hashmap<int,int> (insert
+// growing from empty or into buckets expanded beforehand, find that
+// hits or misses, remove), linked_hashmap<int,int> (ordered iteration,
+// insert of an existing key, which moves it to the end), lru (get hit,
+// get miss, save at capacity) and the Matrix<int> operators.
+// lookups run on sequential, uniform and zipf (s = 0.99) keys over
+// 1K, 16K and 256K elements. each case runs once to warm up, then
+// --reps times on a fresh container, pinned to one cpu; one CSV row
+// per case with the median and the fastest run in ns per operation.
+// the same file builds against lru_vectorversion.hpp, compare the
+// two outputs with --compare:
+//     g++ -std=c++17 -O2 -I../lru suite_bench.cpp -o suite
+//     g++ -std=c++17 -O2 -I../lru -DSJTU_BENCH_VECTORVERSION suite_bench.cpp -o suite_vector
+//     ./suite > lru.csv; ./suite_vector > vector.csv
+//     ./suite --compare lru.csv vector.csv
+// options: --reps N (5), --cpu K (0, -1 to not pin), --filter TEXT
+// (cases whose group/case name contains it), --sizes a,b,c
+
+using clock_type = std::chrono::steady_clock;
+
+struct options{
+    int reps = 5;
+    int cpu = 0;
+    std::string filter;
+    std::vector<int> sizes = {1 << 10, 1 << 14, 1 << 18};
+};
+options opt;
+long long sink = 0;
+
+unsigned next_random(unsigned long long &x){
+    x = x * 6364136223846793005ull + 1442695040888963407ull;
+    return unsigned(x >> 33);
+}
+
+/**
+ * count keys in [0, n): "seq" walks them in order, "uniform" draws
+ * them at random, "zipf" draws rank r with weight 1 / (r + 1)^0.99
+ * and scatters the ranks over the keys
+ */
+std::vector<int> make_keys(const std::string &distribution, int n, size_t count, unsigned long long seed){
+    std::vector<int> keys(count);
+    if(distribution == "seq") {
+        for(size_t i = 0; i < count; i++)
+            keys[i] = int(i % size_t(n));
+    }else if(distribution == "uniform") {
+        for(size_t i = 0; i < count; i++)
+            keys[i] = int(next_random(seed) % unsigned(n));
+    }else {
+        std::vector<double> cdf(n);
+        double sum = 0;
+        for(int i = 0; i < n; i++)
+            cdf[i] = sum += 1 / std::pow(i + 1.0, 0.99);
+        for(size_t i = 0; i < count; i++) {
+            double u = next_random(seed) / 2147483648.0 * sum;
+            int rank = int(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+            keys[i] = int((rank * 2654435761u) % unsigned(n));
+        }
+    }
+    return keys;
+}
+
+/**
+ * 0 .. n - 1, shuffled unless distribution is "seq"
+ */
+std::vector<int> key_set(const std::string &distribution, int n){
+    std::vector<int> keys(n);
+    for(int i = 0; i < n; i++)
+        keys[i] = i;
+    unsigned long long seed = 7;
+    if(distribution != "seq")
+        for(int i = n - 1; i > 0; i--)
+            std::swap(keys[i], keys[next_random(seed) % unsigned(i + 1)]);
+    return keys;
+}
+
+bool selected(const std::string &group, const std::string &name){
+    return opt.filter.empty() || (group + "/" + name).find(opt.filter) != std::string::npos;
+}
+
+/**
+ * setup() builds a fresh state untimed, body(state) is timed and does
+ * ops operations; one warmup run, then opt.reps timed ones
+ */
+template<class Setup, class Body>
+void run_case(const std::string &group, const std::string &name, const std::string &distribution,
+              int size, size_t ops, Setup setup, Body body){
+    if(!selected(group, name))
+        return;
+    std::vector<double> ns;
+    for(int rep = -1; rep < opt.reps; rep++) {
+        auto state = setup();
+        auto start = clock_type::now();
+        body(*state);
+        double elapsed = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+        if(rep >= 0)
+            ns.push_back(elapsed / double(ops));
+    }
+    std::sort(ns.begin(), ns.end());
+    std::cout << SJTU_BENCH_IMPL << "," << group << "," << name << "," << distribution << ","
+              << size << "," << ops << "," << std::fixed << std::setprecision(2)
+              << ns[ns.size() / 2] << "," << ns[0] << std::endl;
+}
+
+template<class T, class... Args>
+std::unique_ptr<T> make(Args&&... args){
+    return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+void double_list_cases(int n){
+    typedef sjtu::double_list<int> list;
+    auto empty = []{ return make<list>(); };
+    auto full = [n]{
+        auto l = make<list>();
+        for(int i = 0; i < n; i++)
+            l->insert_tail(i);
+        return l;
+    };
+    run_case("double_list", "insert_tail", "seq", n, n, empty, [n](list &l){
+        for(int i = 0; i < n; i++)
+            l.insert_tail(i);
+    });
+    run_case("double_list", "insert_head", "seq", n, n, empty, [n](list &l){
+        for(int i = 0; i < n; i++)
+            l.insert_head(i);
+    });
+    run_case("double_list", "erase", "seq", n, n, full, [n](list &l){
+        for(int i = 0; i < n; i++)
+            l.erase(l.begin());
+    });
+    run_case("double_list", "iterate", "seq", n, n, full, [](list &l){
+        for(auto it = l.begin(); it != l.end(); ++it)
+            sink += *it;
+    });
+}
+
+void hashmap_cases(int n, const std::string &distribution, const std::vector<int> &stream){
+    typedef sjtu::hashmap<int,int> map;
+    typedef typename map::value_type value_type;
+    std::vector<int> keys = key_set(distribution, n);
+    auto full = [&keys]{
+        auto m = make<map>();
+        for(int key : keys)
+            m->insert(value_type(key, key));
+        return m;
+    };
+    if(distribution != "zipf") {
+        run_case("hashmap", "insert_expand", distribution, n, n, []{ return make<map>(); }, [&keys](map &m){
+            for(int key : keys)
+                m.insert(value_type(key, key));
+        });
+        run_case("hashmap", "insert_presized", distribution, n, n, [n]{
+            auto m = make<map>();
+            while(m->bucket.size() < size_t(n))
+                m->expand();
+            return m;
+        }, [&keys](map &m){
+            for(int key : keys)
+                m.insert(value_type(key, key));
+        });
+        run_case("hashmap", "remove", distribution, n, n, full, [&keys](map &m){
+            for(int key : keys)
+                sink += m.remove(key);
+        });
+    }
+    run_case("hashmap", "find_hit", distribution, n, stream.size(), full, [&stream](map &m){
+        for(int key : stream)
+            sink += m.find(key)->second;
+    });
+    run_case("hashmap", "find_miss", distribution, n, stream.size(), full, [&stream, n](map &m){
+        for(int key : stream)
+            sink += m.find(key + n) == m.end();
+    });
+}
+
+void linked_hashmap_cases(int n, const std::string &distribution, const std::vector<int> &stream){
+    typedef sjtu::linked_hashmap<int,int> map;
+    typedef typename map::value_type value_type;
+    std::vector<int> keys = key_set(distribution, n);
+    auto full = [&keys]{
+        auto m = make<map>();
+        for(int key : keys)
+            m->insert(value_type(key, key));
+        return m;
+    };
+    if(distribution != "zipf")
+        run_case("linked_hashmap", "iterate", distribution, n, n, full, [](map &m){
+            for(auto it = m.begin(); it != m.end(); ++it)
+                sink += it->second;
+        });
+    run_case("linked_hashmap", "insert_existing", distribution, n, stream.size(), full, [&stream](map &m){
+        for(int key : stream)
+            m.insert(value_type(key, key));
+    });
+}
+
+void lru_cases(int n, const std::string &distribution, const std::vector<int> &stream, const std::vector<int> &wide){
+    typedef sjtu::pair<const Integer, Matrix<int> > value_type;
+    std::vector<int> keys = key_set(distribution, n);
+    auto full = [&keys, n]{
+        auto cache = make<sjtu::lru>(n);
+        for(int key : keys)
+            cache->save(value_type(Integer(key), Matrix<int>(4, 4, key)));
+        return cache;
+    };
+    run_case("lru", "get_hit", distribution, n, stream.size(), full, [&stream](sjtu::lru &cache){
+        for(int key : stream)
+            sink += (*cache.get(Integer(key)))[0][0];
+    });
+    run_case("lru", "get_miss", distribution, n, stream.size(), full, [&stream, n](sjtu::lru &cache){
+        for(int key : stream)
+            sink += cache.get(Integer(key + n)) == nullptr;
+    });
+    // keys over 4x the capacity: updates of cached keys and saves
+    // that evict, mixed as the distribution has them
+    std::vector<value_type> values;
+    for(int key : wide)
+        values.push_back(value_type(Integer(key), Matrix<int>(4, 4, key)));
+    run_case("lru", "save_at_capacity", distribution, n, values.size(), full, [&values](sjtu::lru &cache){
+        for(const value_type &v : values)
+            cache.save(v);
+    });
+}
+
+void matrix_cases(){
+    for(int n : {4, 16, 64}) {
+        Matrix<int> a(n, n, 3), b(n, n, 5);
+        size_t ops = size_t(1 << 22) / size_t(n * n) + 1;
+        auto none = []{ return make<int>(0); };
+        run_case("matrix", "copy", "-", n, ops, none, [&](int &){
+            for(size_t i = 0; i < ops; i++) {
+                Matrix<int> c(a);
+                sink += c[0][0];
+            }
+        });
+        run_case("matrix", "add", "-", n, ops, none, [&](int &){
+            for(size_t i = 0; i < ops; i++)
+                sink += (a + b)[0][0];
+        });
+        run_case("matrix", "subtract", "-", n, ops, none, [&](int &){
+            for(size_t i = 0; i < ops; i++)
+                sink += (a - b)[0][0];
+        });
+        run_case("matrix", "scale", "-", n, ops, none, [&](int &){
+            for(size_t i = 0; i < ops; i++)
+                sink += (a * 3)[0][0];
+        });
+        run_case("matrix", "equal", "-", n, ops, none, [&](int &){
+            for(size_t i = 0; i < ops; i++)
+                sink += a == b;
+        });
+        size_t products = ops / size_t(n) + 1;
+        run_case("matrix", "multiply", "-", n, products, none, [&](int &){
+            for(size_t i = 0; i < products; i++)
+                sink += (a * b)[0][0];
+        });
+    }
+}
+
+void pin(int cpu){
+#ifdef __linux__
+    if(cpu < 0)
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if(sched_setaffinity(0, sizeof(set), &set))
+        std::cerr << "could not pin to cpu " << cpu << ", running unpinned" << std::endl;
+#else
+    (void)cpu;
+#endif
+}
+
+/**
+ * read the rows of a CSV written by this program, keyed by group,
+ * case, distribution and size
+ */
+std::vector<std::pair<std::string, std::string> > read_rows(const char *file, std::string &impl){
+    std::vector<std::pair<std::string, std::string> > rows;
+    std::ifstream in(file);
+    std::string line;
+    while(std::getline(in, line)) {
+        std::vector<std::string> field;
+        std::stringstream fields(line);
+        std::string f;
+        while(std::getline(fields, f, ','))
+            field.push_back(f);
+        if(field.size() != 8 || field[0] == "impl")
+            continue;
+        impl = field[0];
+        rows.push_back(std::make_pair(field[1] + "," + field[2] + "," + field[3] + "," + field[4], field[6]));
+    }
+    return rows;
+}
+
+/**
+ * the two runs side by side: median ns per op of each and b / a
+ */
+int compare(const char *a_file, const char *b_file){
+    std::string a_impl, b_impl;
+    auto a = read_rows(a_file, a_impl), b = read_rows(b_file, b_impl);
+    std::cout << "group,case,distribution,size," << a_impl << "," << b_impl << ",ratio" << std::endl;
+    for(auto &row : a)
+        for(auto &other : b)
+            if(row.first == other.first) {
+                double x = std::atof(row.second.c_str()), y = std::atof(other.second.c_str());
+                std::cout << row.first << "," << row.second << "," << other.second << ","
+                          << std::fixed << std::setprecision(2) << (x > 0 ? y / x : 0) << std::endl;
+            }
+    return 0;
+}
+
+int main(int argc, char **argv){
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "--compare" && i + 2 < argc)
+            return compare(argv[i + 1], argv[i + 2]);
+        if(i + 1 >= argc) {
+            std::cerr << "unknown or incomplete option " << arg << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+        if(arg == "--reps")
+            opt.reps = std::max(1, std::atoi(value.c_str()));
+        else if(arg == "--cpu")
+            opt.cpu = std::atoi(value.c_str());
+        else if(arg == "--filter")
+            opt.filter = value;
+        else if(arg == "--sizes") {
+            opt.sizes.clear();
+            std::stringstream list(value);
+            std::string size;
+            while(std::getline(list, size, ','))
+                opt.sizes.push_back(std::max(1, std::atoi(size.c_str())));
+        }else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+    pin(opt.cpu);
+    std::cout << "impl,group,case,distribution,size,ops,median_ns,min_ns" << std::endl;
+    for(int n : opt.sizes) {
+        double_list_cases(n);
+        for(const char *distribution : {"seq", "uniform", "zipf"}) {
+            size_t count = std::max(size_t(n), size_t(1) << 16);
+            std::vector<int> stream = make_keys(distribution, n, count, 1);
+            std::vector<int> wide = make_keys(distribution, 4 * n, count, 2);
+            hashmap_cases(n, distribution, stream);
+            linked_hashmap_cases(n, distribution, stream);
+            lru_cases(n, distribution, stream, wide);
+        }
+    }
+    matrix_cases();
+    std::cerr << "checksum " << sink << std::endl;
+}
@@ -0,0 +1,83 @@
+#include "src.hpp"
+#include "expiring_lru.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// basic_lru<int,int> against expiring_lru<int,int> (per-entry ttl on a
+// timing wheel, see expiring_lru.hpp) with 100K elements: a get that
+// hits, a save that evicts, both with and without ttls. then a trace
+// on a manual clock where every element expires 1 to 1000 ms after its
+// save and time moves 1 ms per 100 operations: how many expired
+// elements are left unreclaimed at worst, against how many are live.
+//     g++ -std=c++17 -O2 -I../lru ttl_bench.cpp
+
+typedef sjtu::pair<const int,int> value_type;
+typedef std::hash<int> H;
+typedef std::equal_to<int> E;
+
+template<class F>
+void time_it(const std::string &name, int ops, F f){
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < ops; i++)
+        f(i);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(40) << name << std::right << std::setw(8)
+              << std::fixed << std::setprecision(1) << ns / ops << " ns/op" << std::endl;
+}
+
+std::vector<int> random_keys(int range, int count){
+    std::vector<int> keys(count);
+    unsigned x = 12345;
+    for(int i = 0; i < count; i++) {
+        x = x * 1103515245 + 12345;
+        keys[i] = int((x >> 4) % unsigned(range));
+    }
+    return keys;
+}
+
+int main(){
+    const int capacity = 100000, ops = 4000000;
+    std::vector<int> hits = random_keys(capacity, ops), misses = random_keys(capacity * 100, ops);
+    long sink = 0;
+    // all three caches are filled before any is timed, so none runs on
+    // a heap the others left behind
+    sjtu::basic_lru<int,int,H,E> plain(capacity);
+    sjtu::expiring_lru<int,int,H,E> untimed(capacity), timed(capacity);
+    const std::chrono::milliseconds hour(3600000);
+    for(int i = 0; i < capacity; i++) {
+        plain.save(value_type(i, i));
+        untimed.save(value_type(i, i));
+        timed.save(value_type(i, i), hour);
+    }
+    time_it("basic_lru get, hit", ops, [&](int i){ sink += *plain.get(hits[i]); });
+    time_it("expiring_lru get, hit, no ttl", ops, [&](int i){ sink += *untimed.get(hits[i]); });
+    time_it("expiring_lru get, hit, 1 h ttl", ops, [&](int i){ sink += *timed.get(hits[i]); });
+    time_it("basic_lru save, evicting", ops, [&](int i){ plain.save(value_type(misses[i], i)); });
+    time_it("expiring_lru save, evicting, no ttl", ops, [&](int i){ untimed.save(value_type(misses[i], i)); });
+    time_it("expiring_lru save, evicting, 1 h ttl", ops, [&](int i){ timed.save(value_type(misses[i], i), hour); });
+    sjtu::expiring_lru<int,int,H,E,sjtu::chained_table,sjtu::lru_policy,sjtu::unit_weigher,sjtu::manual_clock> cache(capacity);
+    std::vector<int> ttls = random_keys(1000, ops);
+    size_t worst = 0, live_then = 0;
+    for(int i = 0; i < ops; i++) {
+        if(i % 100 == 0)
+            cache.clock.advance(1);
+        if(i % 2)
+            cache.save(value_type(misses[i] % (capacity * 2), i), std::chrono::milliseconds(ttls[i] + 1));
+        else if(int *p = cache.get(misses[i] % (capacity * 2)))
+            sink += *p;
+        if(i % 10000 == 9999) {
+            size_t expired = 0;
+            for(auto it = cache.memory.map.begin(); it != cache.memory.map.end(); ++it)
+                expired += cache.memory.map.meta(it).deadline <= cache.clock.now();
+            if(expired >= worst) {
+                worst = expired;
+                live_then = cache.size() - expired;
+            }
+        }
+    }
+    std::cout << "expiring trace: at worst " << worst << " expired elements unreclaimed, "
+              << live_then << " live (" << (sink & 1) << ")" << std::endl;
+}
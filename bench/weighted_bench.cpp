@@ -0,0 +1,83 @@
+#include "src.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+
+// Integer -> Matrix<int> caches under a byte budget (byte_weigher) of
+// 1% and 10% of all the values' bytes, as a read-through cache on a
+// zipf (s = 0.99) trace of 400K accesses over 40K keys. a key's
+// matrix is n x n with n from 2 to 256, log-uniformly, and unrelated
+// to how popular the key is. for each policy: the hit ratio, the
+// byte hit ratio (bytes served from the cache out of all bytes asked
+// for), the most the cache ever weighed against its budget, and
+// Mops/s (allocating the matrices of the misses included).
+//     g++ -std=c++17 -O2 -I../lru weighted_bench.cpp
+
+unsigned next_random(unsigned long long &x){
+    x = x * 6364136223846793005ull + 1442695040888963407ull;
+    return unsigned(x >> 33);
+}
+
+std::vector<int> zipf_keys(int n, double s, size_t count, unsigned long long seed){
+    std::vector<double> cdf(n);
+    double sum = 0;
+    for(int i = 0; i < n; i++)
+        cdf[i] = sum += 1 / std::pow(i + 1.0, s);
+    std::vector<int> keys(count);
+    for(size_t i = 0; i < count; i++) {
+        double u = next_random(seed) / 2147483648.0 * sum;
+        int rank = int(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+        keys[i] = int((rank * 2654435761u) % unsigned(n));
+    }
+    return keys;
+}
+
+template<class Policy>
+void run(const std::string &name, const std::vector<int> &keys, const std::vector<size_t> &side, size_t budget){
+    sjtu::basic_lru<Integer,Matrix<int>,Hash,Equal,sjtu::chained_table,Policy,sjtu::byte_weigher> cache(0);
+    cache.c = budget;
+    size_t hits = 0, peak = 0;
+    double bytes = 0, hit_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int key : keys) {
+        size_t n = side[key];
+        double weight = double(n * n * sizeof(int));
+        bytes += weight;
+        if(cache.get(Integer(key))) {
+            hits++;
+            hit_bytes += weight;
+        }else
+            cache.save(sjtu::pair<const Integer,Matrix<int> >(Integer(key), Matrix<int>(n, n, key)));
+        peak = cache.weight > peak ? cache.weight : peak;
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::setw(8) << name << std::fixed << std::setprecision(2)
+              << std::setw(10) << 100.0 * hits / keys.size() << std::setw(10) << 100.0 * hit_bytes / bytes
+              << std::setw(12) << double(peak) / budget << std::setw(8) << keys.size() / s / 1e6 << std::endl;
+}
+
+int main(){
+    const int n = 40000;
+    std::vector<int> keys = zipf_keys(n, 0.99, 400000, 1);
+    std::vector<size_t> side(n);
+    sjtu::byte_weigher weigher;
+    double total = 0;
+    unsigned long long seed = 2;
+    for(int i = 0; i < n; i++) {
+        side[i] = size_t(std::exp(std::log(2.0) + next_random(seed) / 2147483648.0 * (std::log(256.0) - std::log(2.0))));
+        total += double(weigher(Integer(i), Matrix<int>(side[i], side[i])));
+    }
+    for(double fraction : {0.01, 0.1}) {
+        size_t budget = size_t(total * fraction);
+        std::cout << "budget " << budget / 1024 << " KiB (" << int(fraction * 100) << "% of all values)" << std::endl
+                  << std::setw(8) << "policy" << std::setw(10) << "hit %" << std::setw(10) << "byte %"
+                  << std::setw(12) << "peak/budget" << std::setw(8) << "Mops/s" << std::endl;
+        run<sjtu::lru_policy>("lru", keys, side, budget);
+        run<sjtu::fifo_policy>("fifo", keys, side, budget);
+        run<sjtu::clock_policy>("clock", keys, side, budget);
+        run<sjtu::gdsf_policy>("gdsf", keys, side, budget);
+    }
+}
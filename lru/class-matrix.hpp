@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <vector>
 #include <stdexcept>
+#include <utility>
 
 template<typename _Td>
 class Matrix {
@@ -39,7 +40,10 @@ public:
     Matrix(const Matrix<_Td> &mat)
         : n_rows(mat.n_rows), n_cols(mat.n_cols), data(mat.data) {}
     Matrix(Matrix<_Td> &&mat) noexcept
-        : n_rows(mat.n_rows), n_cols(mat.n_cols), data(mat.data) {}
+        : n_rows(mat.n_rows), n_cols(mat.n_cols), data(std::move(mat.data))
+    {
+        mat.n_rows = mat.n_cols = 0;
+    }
     Matrix<_Td> & operator=(const Matrix<_Td> &rhs)
     {
         this->n_rows = rhs.n_rows;
@@ -47,11 +51,14 @@ public:
         this->data = rhs.data;
         return *this;
     }
-    Matrix<_Td> & operator=(Matrix<_Td> &&rhs)
+    Matrix<_Td> & operator=(Matrix<_Td> &&rhs) noexcept
     {
-        this->n_rows = rhs.n_rows;
-        this->n_cols = rhs.n_cols;
-        this->data = rhs.data;
+        if (this != &rhs) {
+            this->n_rows = rhs.n_rows;
+            this->n_cols = rhs.n_cols;
+            this->data = std::move(rhs.data);
+            rhs.n_rows = rhs.n_cols = 0;
+        }
         return *this;
     }
     inline const size_t & RowSize() const
@@ -140,7 +147,7 @@ Matrix<_Td> operator-(Matrix<_Td> &&mat)
             mat[i][j] = -mat[i][j];
         }
     }
-    return mat;
+    return std::move(mat);
 }
 
 /**
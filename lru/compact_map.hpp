@@ -0,0 +1,534 @@
+#ifndef SJTU_COMPACT_MAP_HPP
+#define SJTU_COMPACT_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+#include "utility.hpp"
+#include "hashing.hpp"
+#include "policy.hpp"
+
+namespace sjtu {
+
+/**
+ * table tag for linked_hashmap (and so basic_lru) only:
+ * compact_linked_hashmap below, nodes live in an arena and are
+ * linked by 32-bit indices instead of pointers
+ */
+struct compact_table {};
+
+/**
+ * fixed-size nodes in chunks of 2^chunk_shift, addressed by a 32-bit
+ * handle (chunk << chunk_shift | offset).
+ * chunks are never moved or freed before release(), so a handle and
+ * the node address behind it stay valid until the node is freed.
+ * freed nodes are kept on a free list threaded through their handles.
+ */
+template<class Node>
+class node_arena{
+	union slot{
+		uint32_t next_free;
+		alignas(Node) unsigned char storage[sizeof(Node)];
+	};
+public:
+	static constexpr uint32_t nil = uint32_t(-1);
+	static constexpr uint32_t chunk_shift = 10;
+	static constexpr uint32_t chunk_nodes = 1u << chunk_shift;
+private:
+	std::vector<slot *> chunks;
+	uint32_t free_list;
+	uint32_t carved; // handles handed out so far, free ones included
+public:
+	node_arena():free_list(nil), carved(0){}
+	node_arena(const node_arena &) = delete;
+	node_arena & operator=(const node_arena &) = delete;
+	~node_arena(){
+		release();
+	}
+	/**
+	 * raw storage for one Node, constructed by the caller
+	 */
+	uint32_t allocate(){
+		if(free_list != nil) {
+			uint32_t h = free_list;
+			free_list = at(h)->next_free;
+			return h;
+		}
+		if(carved == nil)
+			throw std::length_error("node arena: 32-bit handles exhausted");
+		if((carved >> chunk_shift) == chunks.size())
+			chunks.push_back(static_cast<slot *>(::operator new(sizeof(slot) * chunk_nodes)));
+		return carved++;
+	}
+	/**
+	 * give back a node which is already destroyed
+	 */
+	void deallocate(uint32_t h){
+		at(h)->next_free = free_list;
+		free_list = h;
+	}
+	Node *operator[](uint32_t h) const {
+		return reinterpret_cast<Node *>(at(h)->storage);
+	}
+	/**
+	 * free every chunk, all nodes must have been destroyed before
+	 */
+	void release(){
+		for(size_t i = 0; i < chunks.size(); i++)
+			::operator delete(chunks[i]);
+		chunks.clear();
+		free_list = nil;
+		carved = 0;
+	}
+private:
+	slot *at(uint32_t h) const {
+		return chunks[h >> chunk_shift] + (h & (chunk_nodes - 1));
+	}
+};
+
+/**
+ * linked_hashmap with the same interface, but every node sits in a
+ * node_arena and carries three 32-bit links (order pre/next and the
+ * bucket chain), and a bucket is a 32-bit handle too: 16 bytes of
+ * links per element instead of 32.
+ * walking the order or a chain touches a few dense chunks instead of
+ * nodes spread over the heap.
+ * a handle (handle_of) names an element until it is removed.
+ */
+template<
+	class Key,
+	class T,
+	class Hash = std::hash<Key>,
+	class Equal = std::equal_to<Key>,
+	class Meta = no_meta
+> class compact_linked_hashmap{
+public:
+	typedef pair<const Key, T> value_type;
+	typedef uint32_t handle;
+	static constexpr handle nil = node_arena<int>::nil;
+	template<class U, class M = no_meta>
+	using rebind = compact_linked_hashmap<Key, U, Hash, Equal, M>;
+	struct Node :public Meta{
+		handle chain; // next node in the same bucket, right before the key it is probed with
+		value_type data;
+		handle pre, next; // inserting order
+		template<class... Args>
+		Node(Args&&... args):chain(nil), data(std::forward<Args>(args)...), pre(nil), next(nil){}
+	};
+	node_arena<Node> arena;
+	std::vector<handle> bucket;
+	handle head, tail;
+	size_t s;
+	size_t expand_count; // times the buckets were doubled
+	Hash hash_function;
+	Equal equal_function;
+	// --------------------------
+	class const_iterator;
+	class iterator{
+	public:
+		compact_linked_hashmap *map;
+		handle current;
+		// --------------------------
+		iterator():map(nullptr), current(nil){}
+		iterator(compact_linked_hashmap *map, handle t):map(map), current(t){}
+		iterator operator++(int) {
+			iterator old = *this;
+			++*this;
+			return old;
+		}
+		iterator &operator++() {
+			if(current == nil)
+				throw std::out_of_range("++invalid");
+			current = map->node(current)->next;
+			return *this;
+		}
+		iterator operator--(int) {
+			iterator old = *this;
+			--*this;
+			return old;
+		}
+		iterator &operator--() {
+			if(current == nil || map->node(current)->pre == nil)
+				throw std::out_of_range("--invalid");
+			current = map->node(current)->pre;
+			return *this;
+		}
+		value_type &operator*() const {
+			if(current == nil)
+				throw std::out_of_range("invalid");
+			return map->node(current)->data;
+		}
+		value_type *operator->() const noexcept {
+			return &(map->node(current)->data);
+		}
+		bool operator==(const iterator &rhs) const {return current == rhs.current;}
+		bool operator!=(const iterator &rhs) const {return current != rhs.current;}
+		bool operator==(const const_iterator &rhs) const {return current == rhs.current;}
+		bool operator!=(const const_iterator &rhs) const {return current != rhs.current;}
+	};
+	class const_iterator{
+	public:
+		const compact_linked_hashmap *map;
+		handle current;
+		// --------------------------
+		const_iterator():map(nullptr), current(nil){}
+		const_iterator(const compact_linked_hashmap *map, handle t):map(map), current(t){}
+		const_iterator(const iterator &other):map(other.map), current(other.current){}
+		const_iterator operator++(int) {
+			const_iterator old = *this;
+			++*this;
+			return old;
+		}
+		const_iterator &operator++() {
+			if(current == nil)
+				throw std::out_of_range("++invalid");
+			current = map->node(current)->next;
+			return *this;
+		}
+		const_iterator operator--(int) {
+			const_iterator old = *this;
+			--*this;
+			return old;
+		}
+		const_iterator &operator--() {
+			if(current == nil || map->node(current)->pre == nil)
+				throw std::out_of_range("--invalid");
+			current = map->node(current)->pre;
+			return *this;
+		}
+		const value_type &operator*() const {
+			if(current == nil)
+				throw std::out_of_range("invalid");
+			return map->node(current)->data;
+		}
+		const value_type *operator->() const noexcept {
+			return &(map->node(current)->data);
+		}
+		bool operator==(const iterator &rhs) const {return current == rhs.current;}
+		bool operator!=(const iterator &rhs) const {return current != rhs.current;}
+		bool operator==(const const_iterator &rhs) const {return current == rhs.current;}
+		bool operator!=(const const_iterator &rhs) const {return current != rhs.current;}
+	};
+
+	compact_linked_hashmap():bucket(mix_hashing::initial_buckets, nil), head(nil), tail(nil), s(0), expand_count(0){}
+	compact_linked_hashmap(const compact_linked_hashmap &other)
+		:bucket(mix_hashing::initial_buckets, nil), head(nil), tail(nil), s(0), expand_count(0),
+		 hash_function(other.hash_function), equal_function(other.equal_function){
+		for(handle h = other.head; h != nil; h = other.node(h)->next)
+			insert(other.node(h)->data);
+	}
+	compact_linked_hashmap & operator=(const compact_linked_hashmap &other){
+		if(this != &other) {
+			clear();
+			hash_function = other.hash_function;
+			equal_function = other.equal_function;
+			for(handle h = other.head; h != nil; h = other.node(h)->next)
+				insert(other.node(h)->data);
+		}
+		return *this;
+	}
+	~compact_linked_hashmap(){
+		clear();
+	}
+
+	Node *node(handle h) const {
+		return arena[h];
+	}
+	handle handle_of(const iterator &pos) const {
+		return pos.current;
+	}
+	iterator iterator_of(handle h) {
+		return iterator(this, h);
+	}
+
+	T & at(const Key &key) {
+		handle h = find_handle(key);
+		if(h == nil)
+			throw std::out_of_range("key is not valid");
+		return node(h)->data.second;
+	}
+	const T & at(const Key &key) const {
+		handle h = find_handle(key);
+		if(h == nil)
+			throw std::out_of_range("key is not valid");
+		return node(h)->data.second;
+	}
+	T & operator[](const Key &key) {
+		return at(key);
+	}
+	const T & operator[](const Key &key) const {
+		return at(key);
+	}
+
+	iterator begin() { return iterator(this, head); }
+	iterator end() { return iterator(this, nil); }
+	const_iterator cbegin() const { return const_iterator(this, head); }
+	const_iterator cend() const { return const_iterator(this, nil); }
+	const_iterator begin() const { return cbegin(); }
+	const_iterator end() const { return cend(); }
+
+	bool empty() const {
+		return s == 0;
+	}
+	size_t size() const {
+		return s;
+	}
+	/**
+	 * how many times the index grew
+	 */
+	size_t expansions() const {
+		return expand_count;
+	}
+	void clear(){
+		for(handle h = head; h != nil; ) {
+			Node *tmp = node(h);
+			h = tmp->next;
+			tmp->~Node();
+		}
+		arena.release();
+		for(size_t i = 0; i < bucket.size(); i++)
+			bucket[i] = nil;
+		head = tail = nil;
+		s = 0;
+	}
+
+	/**
+	 * the same as linked_hashmap::insert: an existing key takes the
+	 * new value and moves to the end, return false then
+	 */
+	pair<iterator, bool> insert(const value_type &value) {
+		return insert_or_assign(value.first, value.second);
+	}
+	pair<iterator, bool> insert(value_type &&value) {
+		return insert_or_assign(value.first, std::move(value.second));
+	}
+	template<class... Args>
+	pair<iterator, bool> emplace(Args&&... args) {
+		handle h = new_node(std::forward<Args>(args)...);
+		size_t hash_value;
+		handle old = find_handle(node(h)->data.first, hash_value);
+		if(old != nil) {
+			node(old)->data.second = std::move(node(h)->data.second);
+			free_node(h);
+			touch(iterator(this, old));
+			return sjtu::pair(iterator(this, old), false);
+		}
+		link_new(h, hash_value);
+		return sjtu::pair(iterator(this, h), true);
+	}
+	template<class... Args>
+	pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+		size_t hash_value;
+		handle h = find_handle(key, hash_value);
+		if(h != nil)
+			return sjtu::pair(iterator(this, h), false);
+		h = new_node(key, T(std::forward<Args>(args)...));
+		link_new(h, hash_value);
+		return sjtu::pair(iterator(this, h), true);
+	}
+	template<class M>
+	pair<iterator, bool> insert_or_assign(const Key &key, M &&obj) {
+		return insert_or_assign(key, std::forward<M>(obj), size_t(-1));
+	}
+	/**
+	 * see linked_hashmap::insert_or_assign, a new key at limit
+	 * elements takes over the node of the first one
+	 */
+	template<class M>
+	pair<iterator, bool> insert_or_assign(const Key &key, M &&obj, size_t limit) {
+		return insert_or_assign(key, std::forward<M>(obj), limit, hash(key));
+	}
+	template<class M>
+	pair<iterator, bool> insert_or_assign(const Key &key, M &&obj, size_t limit, size_t hash_value) {
+		handle h = find_hashed(key, hash_value);
+		if(h != nil) {
+			node(h)->data.second = std::forward<M>(obj);
+			touch(iterator(this, h));
+			return sjtu::pair(iterator(this, h), false);
+		}
+		if(s >= limit && head != nil)
+			return sjtu::pair(replace(begin(), key, std::forward<M>(obj), hash_value), true);
+		return sjtu::pair(insert_new(key, std::forward<M>(obj), hash_value), true);
+	}
+	template<class M>
+	iterator insert_new(const Key &key, M &&obj, size_t hash_value) {
+		handle h = new_node(key, std::forward<M>(obj));
+		link_new(h, hash_value);
+		return iterator(this, h);
+	}
+	template<class M>
+	iterator replace(iterator victim, const Key &key, M &&obj, size_t hash_value) {
+		if(victim.current == nil)
+			throw std::out_of_range("iterator points to nothing");
+		handle h = victim.current;
+		unlink_index(h);
+		unlink_order(h);
+		node(h)->~Node();
+		s--;
+		try {
+			new (node(h)) Node(key, std::forward<M>(obj));
+		}catch(...) {
+			arena.deallocate(h);
+			throw;
+		}
+		link_new(h, hash_value);
+		return iterator(this, h);
+	}
+	void remove(iterator pos) {
+		if(pos.current == nil)
+			throw std::out_of_range("iterator points to nothing");
+		handle h = pos.current;
+		unlink_index(h);
+		unlink_order(h);
+		free_node(h);
+		s--;
+	}
+	void touch(iterator pos) {
+		if(pos.current == nil)
+			throw std::out_of_range("iterator points to nothing");
+		if(pos.current == tail)
+			return;
+		unlink_order(pos.current);
+		link_tail(pos.current);
+	}
+	void move_before(iterator pos, iterator where) {
+		if(pos.current == nil)
+			throw std::out_of_range("iterator points to nothing");
+		handle h = pos.current;
+		if(h == where.current)
+			return;
+		unlink_order(h);
+		if(where.current == nil) {
+			link_tail(h);
+			return;
+		}
+		handle next = where.current;
+		node(h)->next = next;
+		node(h)->pre = node(next)->pre;
+		if(node(next)->pre != nil)
+			node(node(next)->pre)->next = h;
+		else
+			head = h;
+		node(next)->pre = h;
+	}
+	Meta &meta(iterator pos) {
+		return *node(pos.current);
+	}
+	size_t count(const Key &key) const {
+		return find_handle(key) == nil ? 0 : 1;
+	}
+	iterator find(const Key &key) {
+		return iterator(this, find_handle(key));
+	}
+	/**
+	 * the hashed lookups and prefetches of linked_hashmap,
+	 * for basic_lru's batches
+	 */
+	iterator find(const Key &key, size_t hash_value) {
+		return iterator(this, find_hashed(key, hash_value));
+	}
+	size_t hash(const Key &key) const {
+		return hash_function(key);
+	}
+	void prefetch_bucket(size_t hash_value) const {
+		__builtin_prefetch(&bucket[mix_hashing::index(hash_value, bucket.size())]);
+	}
+	void prefetch_node(size_t hash_value) const {
+		handle first = bucket[mix_hashing::index(hash_value, bucket.size())];
+		if(first != nil)
+			__builtin_prefetch(node(first));
+	}
+	void prefetch_order(size_t hash_value) const {
+		handle h = bucket[mix_hashing::index(hash_value, bucket.size())];
+		if(h != nil && node(h)->pre != nil)
+			__builtin_prefetch(node(node(h)->pre), 1);
+		if(h != nil && node(h)->next != nil)
+			__builtin_prefetch(node(node(h)->next), 1);
+	}
+
+private:
+	handle find_handle(const Key &key) const {
+		size_t hash_value;
+		return find_handle(key, hash_value);
+	}
+	handle find_handle(const Key &key, size_t &hash_value) const {
+		hash_value = hash_function(key);
+		return find_hashed(key, hash_value);
+	}
+	handle find_hashed(const Key &key, size_t hash_value) const {
+		for(handle h = bucket[mix_hashing::index(hash_value, bucket.size())]; h != nil; h = node(h)->chain)
+			if(equal_function(node(h)->data.first, key))
+				return h;
+		return nil;
+	}
+	template<class... Args>
+	handle new_node(Args&&... args) {
+		handle h = arena.allocate();
+		try {
+			new (node(h)) Node(std::forward<Args>(args)...);
+		}catch(...) {
+			arena.deallocate(h);
+			throw;
+		}
+		return h;
+	}
+	void free_node(handle h) {
+		node(h)->~Node();
+		arena.deallocate(h);
+	}
+	void link_new(handle h, size_t hash_value) {
+		handle &first = bucket[mix_hashing::index(hash_value, bucket.size())];
+		node(h)->chain = first;
+		first = h;
+		link_tail(h);
+		if(++s > bucket.size())
+			expand();
+	}
+	void unlink_index(handle h) {
+		handle *link = &bucket[mix_hashing::index(hash_function(node(h)->data.first), bucket.size())];
+		while(*link != h)
+			link = &node(*link)->chain;
+		*link = node(h)->chain;
+	}
+	void link_tail(handle h) {
+		Node *tmp = node(h);
+		tmp->pre = tail;
+		tmp->next = nil;
+		if(tail != nil)
+			node(tail)->next = h;
+		else
+			head = h;
+		tail = h;
+	}
+	void unlink_order(handle h) {
+		Node *tmp = node(h);
+		if(tmp->pre != nil)
+			node(tmp->pre)->next = tmp->next;
+		else
+			head = tmp->next;
+		if(tmp->next != nil)
+			node(tmp->next)->pre = tmp->pre;
+		else
+			tail = tmp->pre;
+	}
+	/**
+	 * double the buckets, walking the order list relinks every node
+	 */
+	void expand() {
+		std::vector<handle> new_bucket(2 * bucket.size(), nil);
+		for(handle h = head; h != nil; h = node(h)->next) {
+			handle &first = new_bucket[mix_hashing::index(hash_function(node(h)->data.first), new_bucket.size())];
+			node(h)->chain = first;
+			first = h;
+		}
+		bucket = std::move(new_bucket);
+		expand_count++;
+	}
+};
+
+}
+
+#endif
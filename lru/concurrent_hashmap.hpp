@@ -0,0 +1,317 @@
+#ifndef SJTU_CONCURRENT_HASHMAP_HPP
+#define SJTU_CONCURRENT_HASHMAP_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include "utility.hpp"
+#include "hashing.hpp"
+#include "epoch.hpp"
+
+namespace sjtu {
+
+/**
+ * a lock-free hash table, Shalev and Shavit's split-ordered list:
+ * all elements sit in one sorted lock-free list (Michael's, deleted
+ * nodes are marked in the low bit of their next pointer), ordered by
+ * the bit-reversed hash, and a bucket is a pointer to a dummy node in
+ * that list. doubling the bucket count moves no element: bucket
+ * b + n is a new dummy node inserted in the middle of bucket b's run
+ * the first time it is used.
+ * the buckets are segments of 1, 2, 4, ... pointers which are never
+ * moved, so a lookup never waits for a resize.
+ * find, insert and remove may all run concurrently from any thread;
+ * nodes are freed through epoch_domain, so a reader never touches a
+ * freed node.
+ * unlike hashmap there are no iterators and an existing key keeps its
+ * value (insert returns false): a value is read while other threads
+ * may be reading it too, so it never changes in place.
+ */
+template<
+	class Key,
+	class T,
+	class Hash = std::hash<Key>,
+	class Equal = std::equal_to<Key>
+> class concurrent_hashmap{
+public:
+	using value_type = pair<const Key, T>;
+private:
+	struct list_node{
+		size_t so_key; // bit-reversed hash, odd for elements, even for dummies
+		std::atomic<uintptr_t> next; // the low bit marks this node deleted
+		list_node(size_t so_key):so_key(so_key), next(0){}
+	};
+	struct value_node :public list_node{
+		value_type data;
+		template<class... Args>
+		value_node(size_t so_key, Args&&... args):list_node(so_key), data(std::forward<Args>(args)...){}
+	};
+	static const size_t segments = 48; // up to 2^48 - 1 buckets
+	static const size_t initial_buckets = 16;
+
+	mutable std::atomic<std::atomic<list_node *> *> bucket[segments];
+	std::atomic<size_t> bucket_count;
+	std::atomic<size_t> elements;
+	Hash hash_function;
+	Equal equal_function;
+public:
+	concurrent_hashmap():bucket_count(initial_buckets), elements(0){
+		for(size_t i = 0; i < segments; i++)
+			bucket[i].store(nullptr, std::memory_order_relaxed);
+		slot(0).store(new list_node(0), std::memory_order_relaxed);
+	}
+	concurrent_hashmap(const concurrent_hashmap &) = delete;
+	concurrent_hashmap & operator=(const concurrent_hashmap &) = delete;
+	/**
+	 * no other thread may use the map any more
+	 */
+	~concurrent_hashmap(){
+		list_node *tmp = slot(0).load();
+		while(tmp) {
+			list_node *tmp_aft = pointer(tmp->next.load());
+			destroy(tmp);
+			tmp = tmp_aft;
+		}
+		for(size_t i = 0; i < segments; i++)
+			delete [] bucket[i].load();
+	}
+
+	size_t size() const {
+		return elements.load(std::memory_order_relaxed);
+	}
+	bool empty() const {
+		return size() == 0;
+	}
+	/**
+	 * copy the value of key into out, return false if not found
+	 */
+	bool find(const Key &key, T &out) const {
+		return visit(key, [&out](const T &value){ out = value; });
+	}
+	/**
+	 * call f(const T &) on the value of key without copying it,
+	 * the value stays alive until f returns even if another thread
+	 * removes it meanwhile
+	 */
+	template<class F>
+	bool visit(const Key &key, F f) const {
+		epoch_guard guard;
+		size_t h = hash_of(key);
+		std::atomic<uintptr_t> *prev;
+		list_node *cur;
+		if(!search(bucket_of(h), regular_key(h), &key, prev, cur))
+			return false;
+		f(static_cast<const T &>(static_cast<value_node *>(cur)->data.second));
+		return true;
+	}
+	size_t count(const Key &key) const {
+		return visit(key, [](const T &){}) ? 1 : 0;
+	}
+	/**
+	 * insert the value_pair if its key is not there yet and return
+	 * true, otherwise leave the map as it is and return false
+	 */
+	bool insert(const value_type &value_pair){
+		return emplace(value_pair);
+	}
+	bool insert(value_type &&value_pair){
+		return emplace(std::move(value_pair));
+	}
+	template<class... Args>
+	bool emplace(Args&&... args){
+		epoch_guard guard;
+		value_node *node = new value_node(0, std::forward<Args>(args)...);
+		size_t h = hash_of(node->data.first);
+		node->so_key = regular_key(h);
+		list_node *start = bucket_of(h);
+		while(true) {
+			std::atomic<uintptr_t> *prev;
+			list_node *cur;
+			if(search(start, node->so_key, &node->data.first, prev, cur)) {
+				delete node;
+				return false;
+			}
+			node->next.store(reinterpret_cast<uintptr_t>(cur), std::memory_order_relaxed);
+			uintptr_t expected = reinterpret_cast<uintptr_t>(cur);
+			if(prev->compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node),
+											 std::memory_order_release, std::memory_order_relaxed))
+				break;
+		}
+		size_t n = bucket_count.load(std::memory_order_relaxed);
+		if(elements.fetch_add(1, std::memory_order_relaxed) + 1 > n)
+			bucket_count.compare_exchange_strong(n, 2 * n, std::memory_order_relaxed);
+		return true;
+	}
+	/**
+	 * the value_pair exists, remove and return true
+	 * otherwise, return false
+	 */
+	bool remove(const Key &key){
+		epoch_guard guard;
+		size_t h = hash_of(key);
+		size_t so_key = regular_key(h);
+		list_node *start = bucket_of(h);
+		while(true) {
+			std::atomic<uintptr_t> *prev;
+			list_node *cur;
+			if(!search(start, so_key, &key, prev, cur))
+				return false;
+			uintptr_t next = cur->next.load(std::memory_order_acquire);
+			if(next & 1)
+				continue;
+			// mark cur deleted, then whoever unlinks it retires it
+			if(!cur->next.compare_exchange_strong(next, next | 1, std::memory_order_acq_rel))
+				continue;
+			uintptr_t expected = reinterpret_cast<uintptr_t>(cur);
+			if(prev->compare_exchange_strong(expected, next, std::memory_order_release, std::memory_order_relaxed))
+				retire(cur);
+			else
+				search(start, so_key, &key, prev, cur);
+			elements.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	/**
+	 * double the number of buckets ahead of the inserts, the new ones
+	 * are set up lazily; only while there are fewer than two buckets
+	 * per element, so calling it again and again can't make a lookup
+	 * allocate a huge segment (insert grows the table by itself anyway)
+	 */
+	void expand(){
+		size_t n = bucket_count.load(std::memory_order_relaxed);
+		if(n < 2 * elements.load(std::memory_order_relaxed) && n < (size_t(1) << (segments - 1)))
+			bucket_count.compare_exchange_strong(n, 2 * n, std::memory_order_relaxed);
+	}
+	size_t buckets() const {
+		return bucket_count.load(std::memory_order_relaxed);
+	}
+
+private:
+	static list_node *pointer(uintptr_t link){
+		return reinterpret_cast<list_node *>(link & ~uintptr_t(1));
+	}
+	static void destroy(list_node *node){
+		if(node->so_key & 1)
+			delete static_cast<value_node *>(node);
+		else
+			delete node;
+	}
+	static void retire(list_node *node){
+		if(node->so_key & 1)
+			epoch_domain::instance().retire(static_cast<value_node *>(node));
+		else
+			epoch_domain::instance().retire(node);
+	}
+	static size_t reverse(size_t x){
+		static_assert(sizeof(size_t) == 8, "64-bit size_t");
+		x = (x >> 1 & 0x5555555555555555ull) | (x & 0x5555555555555555ull) << 1;
+		x = (x >> 2 & 0x3333333333333333ull) | (x & 0x3333333333333333ull) << 2;
+		x = (x >> 4 & 0x0f0f0f0f0f0f0f0full) | (x & 0x0f0f0f0f0f0f0f0full) << 4;
+		return __builtin_bswap64(x);
+	}
+	static size_t regular_key(size_t h){
+		return reverse(h | size_t(1) << (sizeof(size_t) * 8 - 1));
+	}
+	static size_t dummy_key(size_t b){
+		return reverse(b);
+	}
+	size_t hash_of(const Key &key) const {
+		return mix_hashing::mix(hash_function(key));
+	}
+	/**
+	 * the pointer slot of bucket b, segment s holds buckets
+	 * [2^s - 1, 2^(s+1) - 1)
+	 */
+	std::atomic<list_node *> &slot(size_t b) const {
+		size_t i = b + 1;
+		size_t s = sizeof(size_t) * 8 - 1 - __builtin_clzll(i);
+		std::atomic<list_node *> *segment = bucket[s].load(std::memory_order_acquire);
+		if(!segment) {
+			std::atomic<list_node *> *fresh = new std::atomic<list_node *>[size_t(1) << s];
+			for(size_t j = 0; j < (size_t(1) << s); j++)
+				fresh[j].store(nullptr, std::memory_order_relaxed);
+			if(bucket[s].compare_exchange_strong(segment, fresh, std::memory_order_acq_rel))
+				segment = fresh;
+			else
+				delete [] fresh;
+		}
+		return segment[i - (size_t(1) << s)];
+	}
+	/**
+	 * the dummy node of the bucket of hash h, set up first if needed
+	 */
+	list_node *bucket_of(size_t h) const {
+		size_t b = h & (bucket_count.load(std::memory_order_relaxed) - 1);
+		list_node *dummy = slot(b).load(std::memory_order_acquire);
+		return dummy ? dummy : init_bucket(b);
+	}
+	/**
+	 * link the dummy node of bucket b into the run of its parent
+	 * bucket (b without its highest bit), which is set up first
+	 */
+	list_node *init_bucket(size_t b) const {
+		size_t parent = b & ~(size_t(1) << (sizeof(size_t) * 8 - 1 - __builtin_clzll(b)));
+		list_node *start = slot(parent).load(std::memory_order_acquire);
+		if(!start)
+			start = init_bucket(parent);
+		list_node *dummy = new list_node(dummy_key(b));
+		while(true) {
+			std::atomic<uintptr_t> *prev;
+			list_node *cur;
+			if(search(start, dummy->so_key, nullptr, prev, cur)) {
+				// someone else linked it first
+				delete dummy;
+				dummy = cur;
+				break;
+			}
+			dummy->next.store(reinterpret_cast<uintptr_t>(cur), std::memory_order_relaxed);
+			uintptr_t expected = reinterpret_cast<uintptr_t>(cur);
+			if(prev->compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(dummy),
+											 std::memory_order_release, std::memory_order_relaxed))
+				break;
+		}
+		list_node *expected = nullptr;
+		slot(b).compare_exchange_strong(expected, dummy, std::memory_order_acq_rel);
+		return dummy;
+	}
+	/**
+	 * Michael's search from start: prev ends at the link to cur, the
+	 * first node not before (so_key, key), unlinking and retiring the
+	 * deleted nodes on the way; key == nullptr looks for the dummy of
+	 * so_key. return whether cur is the node looked for.
+	 * the caller holds an epoch_guard.
+	 */
+	bool search(list_node *start, size_t so_key, const Key *key,
+				std::atomic<uintptr_t> *&prev, list_node *&cur) const {
+	retry:
+		prev = &start->next;
+		cur = pointer(prev->load(std::memory_order_acquire));
+		while(cur) {
+			uintptr_t next = cur->next.load(std::memory_order_acquire);
+			if(prev->load(std::memory_order_acquire) != reinterpret_cast<uintptr_t>(cur))
+				goto retry;
+			if(next & 1) {
+				uintptr_t expected = reinterpret_cast<uintptr_t>(cur);
+				if(!prev->compare_exchange_strong(expected, next & ~uintptr_t(1),
+												  std::memory_order_acq_rel, std::memory_order_relaxed))
+					goto retry;
+				retire(cur);
+				cur = pointer(next);
+				continue;
+			}
+			if(cur->so_key > so_key)
+				return false;
+			if(cur->so_key == so_key && (key ? equal_function(static_cast<value_node *>(cur)->data.first, *key) : true))
+				return true;
+			prev = &cur->next;
+			cur = pointer(next);
+		}
+		return false;
+	}
+};
+
+}
+
+#endif
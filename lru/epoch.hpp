@@ -0,0 +1,172 @@
+#ifndef SJTU_EPOCH_HPP
+#define SJTU_EPOCH_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace sjtu {
+
+/**
+ * epoch based reclamation for the lock-free structures.
+ * a thread reads shared nodes only inside an epoch_guard, which
+ * announces the global epoch it saw. a node that has been unlinked is
+ * retire()d instead of deleted; it is put in a bag of the epoch it was
+ * retired in and freed once the global epoch is two further: by then
+ * every thread that could still hold it has left its guard.
+ * the global epoch moves on when every thread inside a guard has seen
+ * the current one.
+ * there is one process wide domain, a thread takes a record from it
+ * on first use and gives it back (with whatever is still in its bags)
+ * when it exits.
+ */
+class epoch_domain{
+	struct retired{
+		void *p;
+		void (*deleter)(void *);
+	};
+	static const unsigned active = 1; // the low bit of record::epoch
+	static const size_t retires_per_advance = 64;
+	struct alignas(64) record{
+		std::atomic<unsigned> epoch; // epoch << 1 | active, 0 outside of guards
+		std::atomic<bool> in_use;
+		record *next;
+		unsigned depth; // nested guards
+		size_t retires;
+		unsigned bag_epoch[3];
+		std::vector<retired> bags[3];
+		record():epoch(0), in_use(true), next(nullptr), depth(0), retires(0), bag_epoch{0, 0, 0}{}
+	};
+	std::atomic<unsigned> global_epoch;
+	std::atomic<record *> records;
+
+	/**
+	 * frees the record's bags at process exit and hands it back when
+	 * its thread ends
+	 */
+	struct owner{
+		record *r;
+		owner():r(nullptr){}
+		~owner(){
+			if(r)
+				r->in_use.store(false, std::memory_order_release);
+		}
+	};
+public:
+	epoch_domain():global_epoch(1), records(nullptr){}
+	epoch_domain(const epoch_domain &) = delete;
+	epoch_domain & operator=(const epoch_domain &) = delete;
+	~epoch_domain(){
+		record *r = records.load();
+		while(r) {
+			record *tmp = r->next;
+			for(int i = 0; i < 3; i++)
+				free_bag(r->bags[i]);
+			delete r;
+			r = tmp;
+		}
+	}
+	static epoch_domain &instance(){
+		static epoch_domain domain;
+		return domain;
+	}
+
+	void enter(){
+		record *r = mine();
+		if(r->depth++)
+			return;
+		// announce an epoch that is still the global one afterwards
+		unsigned e = global_epoch.load();
+		while(true) {
+			r->epoch.store(e << 1 | active);
+			unsigned now = global_epoch.load();
+			if(now == e)
+				break;
+			e = now;
+		}
+	}
+	void leave(){
+		record *r = mine();
+		if(--r->depth)
+			return;
+		r->epoch.store(0, std::memory_order_release);
+	}
+	/**
+	 * p is unreachable for new readers, delete it once no guard
+	 * that may have seen it is left
+	 */
+	template<class T>
+	void retire(T *p){
+		record *r = mine();
+		unsigned e = global_epoch.load();
+		collect(r, e);
+		size_t i = e % 3;
+		if(r->bag_epoch[i] != e) {
+			free_bag(r->bags[i]);
+			r->bag_epoch[i] = e;
+		}
+		r->bags[i].push_back(retired{p, [](void *q){ delete static_cast<T *>(q); }});
+		if(++r->retires % retires_per_advance == 0)
+			try_advance(e);
+	}
+private:
+	record *mine(){
+		static thread_local owner me;
+		if(!me.r)
+			me.r = acquire();
+		return me.r;
+	}
+	record *acquire(){
+		for(record *r = records.load(); r; r = r->next) {
+			bool expected = false;
+			if(!r->in_use.load() && r->in_use.compare_exchange_strong(expected, true))
+				return r;
+		}
+		record *r = new record();
+		record *head = records.load();
+		do {
+			r->next = head;
+		}while(!records.compare_exchange_weak(head, r));
+		return r;
+	}
+	/**
+	 * free the bags that are two epochs old
+	 */
+	void collect(record *r, unsigned e){
+		for(int i = 0; i < 3; i++)
+			if(!r->bags[i].empty() && r->bag_epoch[i] + 2 <= e)
+				free_bag(r->bags[i]);
+	}
+	static void free_bag(std::vector<retired> &bag){
+		for(size_t i = 0; i < bag.size(); i++)
+			bag[i].deleter(bag[i].p);
+		bag.clear();
+	}
+	void try_advance(unsigned e){
+		for(record *r = records.load(); r; r = r->next) {
+			unsigned seen = r->epoch.load();
+			if((seen & active) && (seen >> 1) != (e << 1 >> 1))
+				return;
+		}
+		global_epoch.compare_exchange_strong(e, e + 1);
+	}
+};
+
+/**
+ * stay in the current epoch for the guard's lifetime
+ */
+class epoch_guard{
+public:
+	epoch_guard(){
+		epoch_domain::instance().enter();
+	}
+	~epoch_guard(){
+		epoch_domain::instance().leave();
+	}
+	epoch_guard(const epoch_guard &) = delete;
+	epoch_guard & operator=(const epoch_guard &) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef SJTU_EXPIRING_LRU_HPP
+#define SJTU_EXPIRING_LRU_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <utility>
+#include "lru.hpp"
+#include "timing_wheel.hpp"
+
+namespace sjtu {
+
+/**
+ * milliseconds of a monotonic clock, read for real only by refresh()
+ * and on every 256th now(): the time a get compares deadlines with
+ * costs a counter, not a clock read. an element may so outlive its
+ * ttl by up to 256 gets, or until the next save, which refreshes.
+ * refresh() reads CLOCK_MONOTONIC_COARSE where there is one (a few
+ * ms of resolution, but no syscall and a fraction of the cost of a
+ * precise read), steady_clock elsewhere.
+ */
+class coarse_clock{
+	uint64_t cached;
+	unsigned reads;
+public:
+	static const unsigned period = 256;
+	coarse_clock():reads(0){
+		refresh();
+	}
+	uint64_t now(){
+		if(++reads == period)
+			return refresh();
+		return cached;
+	}
+	uint64_t refresh(){
+		reads = 0;
+#ifdef CLOCK_MONOTONIC_COARSE
+		timespec t;
+		clock_gettime(CLOCK_MONOTONIC_COARSE, &t);
+		cached = uint64_t(t.tv_sec) * 1000 + uint64_t(t.tv_nsec) / 1000000;
+#else
+		cached = uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+		return cached;
+	}
+};
+
+/**
+ * a clock that only moves when told to, to test with
+ */
+class manual_clock{
+	uint64_t time;
+public:
+	manual_clock():time(0){}
+	uint64_t now(){
+		return time;
+	}
+	uint64_t refresh(){
+		return time;
+	}
+	void set(uint64_t t){
+		time = t;
+	}
+	void advance(uint64_t ms){
+		time += ms;
+	}
+};
+
+/**
+ * Policy plus a deadline per element: the timer of an element with a
+ * ttl sits in the hooks' timing wheel and goes with the element.
+ * the cache sets deadline and saving around a save, an element saved
+ * while saving is false (never, by expiring_lru) keeps its deadline.
+ */
+template<class Policy>
+struct expiring{
+	static const uint64_t never = uint64_t(-1);
+	static const bool elements_only = is_elements_only<Policy>::value;
+	struct meta :Policy::meta{
+		uint64_t deadline;
+		uint32_t timer;
+	};
+	template<class Map>
+	struct hooks :Policy::template hooks<Map>{
+		typedef typename Policy::template hooks<Map> base;
+		typedef typename Map::iterator iterator;
+		typedef timing_wheel<iterator> wheel_type;
+		wheel_type wheel;
+		uint64_t deadline;
+		bool saving;
+		hooks():deadline(never), saving(false){}
+		template<class Cache>
+		void on_insert(Cache &cache, iterator it) {
+			meta &m = cache.map.meta(it);
+			m.deadline = never;
+			m.timer = wheel_type::none;
+			if(saving)
+				set_deadline(m, it);
+			base::on_insert(cache, it);
+		}
+		template<class Cache>
+		void on_hit(Cache &cache, iterator it) {
+			if(saving)
+				set_deadline(cache.map.meta(it), it);
+			base::on_hit(cache, it);
+		}
+		template<class Cache>
+		void on_evict(Cache &cache, iterator it) {
+			meta &m = cache.map.meta(it);
+			if(m.timer != wheel_type::none) {
+				wheel.cancel(m.timer);
+				m.timer = wheel_type::none;
+			}
+			base::on_evict(cache, it);
+		}
+		template<class Cache>
+		void on_clear(Cache &cache) {
+			wheel.clear();
+			base::on_clear(cache);
+		}
+	private:
+		void set_deadline(meta &m, iterator it) {
+			m.deadline = deadline;
+			if(deadline == never) {
+				if(m.timer != wheel_type::none)
+					wheel.cancel(m.timer);
+				m.timer = wheel_type::none;
+			}else if(m.timer != wheel_type::none)
+				wheel.reschedule(m.timer, deadline);
+			else
+				m.timer = wheel.schedule(it, deadline);
+		}
+	};
+};
+
+/**
+ * a basic_lru whose elements may be saved with a ttl: an element is
+ * gone once its ttl has passed, whatever the policy thinks of it.
+ * - a get of an expired element removes it and misses; other than
+ *   that a get costs a deadline compare, no clock read, no allocation.
+ * - a save reclaims up to reclaim_batch expired elements from the
+ *   timing wheel before it stores, so expired elements nobody asks for
+ *   don't hold the capacity for long, and no save pays for many.
+ * - expire() reclaims every expired element.
+ * saving a key again sets its ttl anew, and without a ttl clears it.
+ */
+template<
+	class Key,
+	class T,
+	class Hash,
+	class Equal,
+	class Table = chained_table,
+	class Policy = lru_policy,
+	class Weigher = unit_weigher,
+	class Clock = coarse_clock
+> class expiring_lru{
+	using value_type = sjtu::pair<const Key, T>;
+	using cache_type = basic_lru<Key,T,Hash,Equal,Table,expiring<Policy>,Weigher>;
+	using iterator = typename cache_type::iterator;
+	static const uint64_t never = expiring<Policy>::never;
+public:
+	static const size_t reclaim_batch = 16;
+	cache_type memory;
+	Clock clock;
+	expiring_lru(int size):memory(size){
+		memory.policy.wheel.start(clock.now());
+	}
+	/**
+	 * save the value_pair with no ttl
+	 */
+	void save(const value_type &v) {
+		store(v, nullptr);
+	}
+	void save(value_type &&v) {
+		store(std::move(v), nullptr);
+	}
+	/**
+	 * save the value_pair, to expire ttl from now
+	 */
+	void save(const value_type &v, std::chrono::milliseconds ttl) {
+		store(v, &ttl);
+	}
+	void save(value_type &&v, std::chrono::milliseconds ttl) {
+		store(std::move(v), &ttl);
+	}
+	/**
+	 * return a pointer contain the value, nullptr if it is not there
+	 * or expired
+	 */
+	T* get(const Key &v) {
+		uint64_t start = memory.latency.start();
+		iterator it = memory.map.find(v);
+		if(it != memory.map.end() && memory.map.meta(it).deadline <= clock.now()) {
+			memory.remove(it);
+			it = memory.map.end();
+		}
+		if(it == memory.map.end()) {
+			memory.counters.miss();
+			memory.policy.on_miss(memory, v);
+			memory.latency.miss(start);
+			return nullptr;
+		}
+		memory.counters.hit();
+		memory.policy.on_hit(memory, it);
+		memory.latency.hit(start);
+		return &(it->second);
+	}
+	/**
+	 * remove every expired element, return how many there were
+	 */
+	size_t expire() {
+		return reclaim(clock.refresh(), size_t(-1));
+	}
+	/**
+	 * the number of elements, expired ones not reclaimed yet included
+	 */
+	size_t size() const {
+		return memory.map.size();
+	}
+	/**
+	 * the counters so far, expired elements count as neither evicted
+	 * nor hit
+	 */
+	cache_stats stats() const {
+		return memory.stats();
+	}
+	void clear() {
+		memory.clear();
+	}
+private:
+	/**
+	 * deadline and saving set on the hooks for one save, and put
+	 * back when it is over, by a throw too
+	 */
+	class saving_scope{
+		decltype(cache_type::policy) &hooks;
+	public:
+		saving_scope(decltype(cache_type::policy) &hooks, uint64_t deadline):hooks(hooks) {
+			hooks.deadline = deadline;
+			hooks.saving = true;
+		}
+		~saving_scope() {
+			hooks.saving = false;
+			hooks.deadline = never;
+		}
+	};
+	size_t reclaim(uint64_t now, size_t limit) {
+		return memory.policy.wheel.advance(now, limit, [this](iterator it){
+			memory.map.meta(it).timer = timing_wheel<iterator>::none;
+			memory.remove(it);
+		});
+	}
+	/**
+	 * the clock is read once per save, for the reclaim and the
+	 * deadline, a ttl of 0 or less is expired already
+	 */
+	template<class V>
+	void store(V &&v, const std::chrono::milliseconds *ttl) {
+		uint64_t now = clock.refresh();
+		reclaim(now, reclaim_batch);
+		uint64_t deadline = never;
+		if(ttl)
+			deadline = ttl->count() > 0 ? now + uint64_t(ttl->count()) : now;
+		saving_scope scope(memory.policy, deadline);
+		memory.save(std::forward<V>(v));
+	}
+};
+
+typedef expiring_lru<Integer, Matrix<int>, Hash, Equal> timed_lru;
+}
+
+#endif
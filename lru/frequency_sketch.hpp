@@ -0,0 +1,141 @@
+#ifndef SJTU_FREQUENCY_SKETCH_HPP
+#define SJTU_FREQUENCY_SKETCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "hashing.hpp"
+
+namespace sjtu {
+
+/**
+ * how often each key was seen lately, approximately, for TinyLFU
+ * admission: a count-min sketch of 4-bit counters in the style of
+ * Caffeine's, with the doorkeeper of the TinyLFU paper in front.
+ * - the 4 counters of a key are in 4 different words of one 64-byte
+ *   block, so an access costs one cache line (plus one doorkeeper
+ *   word) and no allocation.
+ * - the first sighting of a key only sets its 2 bits in the
+ *   doorkeeper Bloom filter; keys seen once (most of a scan) never
+ *   reach the counters.
+ * - every sample_size accesses all counters are halved and the
+ *   doorkeeper is emptied, so old popularity fades.
+ * estimates never fall below the true count of the current period
+ * (until it passes 15) and may be above it by collisions.
+ */
+class frequency_sketch{
+	struct alignas(64) block{
+		uint64_t word[8];
+	};
+	std::vector<block> table;
+	std::vector<uint64_t> doorkeeper;
+	size_t block_mask, door_mask;
+	size_t capacity;
+	size_t additions;
+	size_t sample_size;
+public:
+	frequency_sketch():block_mask(0), door_mask(0), capacity(0), additions(0), sample_size(0){}
+
+	/**
+	 * sized for a cache of n elements: 16 counters and 10 doorkeeper
+	 * bits per element, rounded up to powers of two; a new size
+	 * starts from nothing
+	 */
+	void ensure_capacity(size_t n){
+		if(n <= capacity)
+			return;
+		capacity = n;
+		table.assign(ceil_pow2(n < 8 ? 1 : n / 8), block());
+		sample_size = 10 * n;
+		doorkeeper.assign(ceil_pow2(sample_size / 64 + 1), 0);
+		block_mask = table.size() - 1;
+		door_mask = doorkeeper.size() - 1;
+		additions = 0;
+	}
+	/**
+	 * the estimated number of times hash_value was seen lately, 0-16
+	 */
+	unsigned frequency(size_t hash_value) const {
+		if(table.empty())
+			return 0;
+		unsigned long long x = mix_hashing::mix(hash_value);
+		unsigned long long y = spread(x);
+		const block &b = table[x & block_mask];
+		unsigned count = 15;
+		for(unsigned i = 0; i < 4; i++) {
+			unsigned byte = unsigned(y >> (8 * i));
+			unsigned c = unsigned(b.word[2 * i + (byte & 1)] >> (((byte >> 1) & 15) * 4)) & 15;
+			count = c < count ? c : count;
+		}
+		uint64_t door = doorkeeper[(x >> 32) & door_mask];
+		uint64_t bits = door_bits(y);
+		return count + ((door & bits) == bits);
+	}
+	/**
+	 * record one access of hash_value
+	 */
+	void increment(size_t hash_value){
+		if(table.empty())
+			return;
+		unsigned long long x = mix_hashing::mix(hash_value);
+		unsigned long long y = spread(x);
+		if(++additions >= sample_size)
+			reset();
+		uint64_t &door = doorkeeper[(x >> 32) & door_mask];
+		uint64_t bits = door_bits(y);
+		if((door & bits) != bits) {
+			door |= bits;
+			return;
+		}
+		block &b = table[x & block_mask];
+		for(unsigned i = 0; i < 4; i++) {
+			unsigned byte = unsigned(y >> (8 * i));
+			uint64_t &word = b.word[2 * i + (byte & 1)];
+			unsigned shift = ((byte >> 1) & 15) * 4;
+			// saturate at 15 without a branch
+			word += uint64_t(((word >> shift) & 15) != 15) << shift;
+		}
+	}
+	/**
+	 * forget everything, keeping the size
+	 */
+	void clear(){
+		for(size_t i = 0; i < table.size(); i++)
+			table[i] = block();
+		for(size_t i = 0; i < doorkeeper.size(); i++)
+			doorkeeper[i] = 0;
+		additions = 0;
+	}
+private:
+	static size_t ceil_pow2(size_t n){
+		size_t p = 1;
+		while(p < n)
+			p <<= 1;
+		return p;
+	}
+	/**
+	 * the counter and doorkeeper bits come from a second, cheaper
+	 * hash of the mixed one
+	 */
+	static unsigned long long spread(unsigned long long x){
+		return (x ^ x >> 29) * 0xbf58476d1ce4e5b9ull;
+	}
+	static uint64_t door_bits(unsigned long long y){
+		return 1ull << ((y >> 40) & 63) | 1ull << ((y >> 46) & 63);
+	}
+	/**
+	 * halve every counter and empty the doorkeeper
+	 */
+	void reset(){
+		for(size_t i = 0; i < table.size(); i++)
+			for(size_t j = 0; j < 8; j++)
+				table[i].word[j] = (table[i].word[j] >> 1) & 0x7777777777777777ull;
+		for(size_t i = 0; i < doorkeeper.size(); i++)
+			doorkeeper[i] = 0;
+		additions /= 2;
+	}
+};
+
+}
+
+#endif
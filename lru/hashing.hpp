@@ -0,0 +1,81 @@
+#ifndef SJTU_HASHING_HPP
+#define SJTU_HASHING_HPP
+
+#include <cstddef>
+
+namespace sjtu {
+
+static const int initial_size = 10;
+
+/**
+ * hashing policies of the chained tables: how many buckets to start
+ * with and how a hash value picks one of them.
+ * the bucket count always doubles on expand.
+ */
+
+/**
+ * hash % n, n = 10, 20, 40, ...
+ * a division on every operation, and the buckets are only as good
+ * as the low bits of the hash
+ */
+struct modulo_hashing{
+	static const size_t initial_buckets = initial_size;
+	static size_t index(size_t h, size_t n) {
+		return h % n;
+	}
+};
+
+/**
+ * n = 16, 32, 64, ... and the hash goes through the splitmix64
+ * finalizer before masking, so sequential or strided keys (e.g. from
+ * an identity std::hash<int>) still spread over all buckets.
+ * the price is paid by dense keys: under modulo_hashing 0 .. n-1 get
+ * a bucket each, next to each other, here they land at random with
+ * chains of random length. so it is opt-in, see mixed_chained_table
+ * (and the README on which to pick)
+ */
+struct mix_hashing{
+	static const size_t initial_buckets = 16;
+	static unsigned long long mix(unsigned long long h) {
+		h ^= h >> 30;
+		h *= 0xbf58476d1ce4e5b9ull;
+		h ^= h >> 27;
+		h *= 0x94d049bb133111ebull;
+		h ^= h >> 31;
+		return h;
+	}
+	static size_t index(size_t h, size_t n) {
+		return mix(h) & (n - 1);
+	}
+};
+
+/**
+ * table tag, the last template argument of hashmap and linked_hashmap:
+ * a list per bucket, Hashing is one of the policies above.
+ * with Incremental the table grows the way Redis dict does: the
+ * doubled bucket vector lives next to the old one and every insert
+ * or remove moves a few old buckets over, instead of one expand()
+ * moving all of them.
+ * see robin_hood.hpp and swiss_table.hpp for the other tables,
+ * and compact_map.hpp for the linked_hashmap only compact_table.
+ */
+template<class Hashing, bool Incremental = false>
+struct basic_chained_table{
+	typedef Hashing hashing;
+	static const bool incremental = Incremental;
+	// buckets an incremental step may look at without moving anything
+	static const size_t empty_visits = 10;
+};
+/**
+ * the default: modulo_hashing, which suits the dense integer keys
+ * these containers mostly see. keys with a stride, or hashes whose
+ * low bits repeat, want the mixed_ tables.
+ */
+typedef basic_chained_table<modulo_hashing> chained_table;
+typedef basic_chained_table<modulo_hashing, true> incremental_chained_table;
+typedef basic_chained_table<mix_hashing> mixed_chained_table;
+typedef basic_chained_table<mix_hashing, true> mixed_incremental_chained_table;
+
+}
+
+#endif
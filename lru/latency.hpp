@@ -0,0 +1,237 @@
+#ifndef SJTU_LATENCY_HPP
+#define SJTU_LATENCY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#ifdef SJTU_LATENCY
+#include <atomic>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SJTU_LATENCY_RDTSC
+#endif
+#endif
+
+namespace sjtu {
+
+#ifdef SJTU_LATENCY
+
+/**
+ * the time stamp counter where there is one, steady_clock's
+ * nanoseconds elsewhere: ticks() is what a histogram records, and
+ * ns_per_tick() turns ticks into nanoseconds when they are read out.
+ */
+struct tick_clock{
+	static uint64_t ticks(){
+#ifdef SJTU_LATENCY_RDTSC
+		return __rdtsc();
+#else
+		return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+	/**
+	 * measured once, against steady_clock over about 10 ms, the first
+	 * time anyone asks
+	 */
+	static double ns_per_tick(){
+#ifdef SJTU_LATENCY_RDTSC
+		static const double ratio = calibrate();
+		return ratio;
+#else
+		return 1;
+#endif
+	}
+private:
+	static double calibrate(){
+		auto start = std::chrono::steady_clock::now();
+		uint64_t first = ticks();
+		double ns;
+		do
+			ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		while(ns < 1e7);
+		return ns / double(ticks() - first);
+	}
+};
+
+/**
+ * an HDR-style log-linear histogram of tick counts: values below 64
+ * each have a bucket, above that every power of two is cut into 32
+ * buckets, so a value is known to within 1/32 (3%) at any size; up
+ * to 2^40 ticks (minutes), anything longer lands in the last bucket.
+ * record() is one relaxed atomic add, so any number of threads may
+ * record into one histogram without a lock, and histograms of
+ * several threads or shards add up with merge().
+ */
+class latency_histogram{
+	static const unsigned sub_bits = 5;
+	static const uint64_t sub = uint64_t(1) << sub_bits;
+	static const unsigned max_bits = 40;
+public:
+	static const size_t buckets = (max_bits - sub_bits + 1) * sub;
+private:
+	std::atomic<uint64_t> counts[buckets];
+	static size_t bucket_of(uint64_t v){
+		if(v < 2 * sub)
+			return size_t(v);
+		unsigned shift = 63 - __builtin_clzll(v) - sub_bits;
+		size_t i = size_t(shift + 1) * sub + size_t((v >> shift) - sub);
+		return i < buckets ? i : buckets - 1;
+	}
+	/**
+	 * the largest value of bucket i
+	 */
+	static uint64_t highest(size_t i){
+		if(i < 2 * sub)
+			return i;
+		unsigned shift = unsigned(i / sub) - 1;
+		return (((i % sub) + sub + 1) << shift) - 1;
+	}
+public:
+	latency_histogram(){
+		clear();
+	}
+	latency_histogram(const latency_histogram &) = delete;
+	latency_histogram & operator=(const latency_histogram &) = delete;
+
+	void record(uint64_t ticks){
+		counts[bucket_of(ticks)].fetch_add(1, std::memory_order_relaxed);
+	}
+	void merge(const latency_histogram &other){
+		for(size_t i = 0; i < buckets; i++)
+			counts[i].fetch_add(other.counts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	void clear(){
+		for(size_t i = 0; i < buckets; i++)
+			counts[i].store(0, std::memory_order_relaxed);
+	}
+	uint64_t count() const {
+		uint64_t total = 0;
+		for(size_t i = 0; i < buckets; i++)
+			total += counts[i].load(std::memory_order_relaxed);
+		return total;
+	}
+	/**
+	 * the q-th quantile (q in [0, 1], 1 for the max) in ns: the top of
+	 * the bucket it falls in, 0 if nothing was recorded
+	 */
+	double percentile(double q) const {
+		uint64_t total = count();
+		if(!total)
+			return 0;
+		uint64_t rank = uint64_t(q * double(total) + 0.5);
+		rank = rank < 1 ? 1 : rank > total ? total : rank;
+		uint64_t seen = 0;
+		size_t i = 0;
+		for(; i < buckets; i++)
+			if((seen += counts[i].load(std::memory_order_relaxed)) >= rank)
+				break;
+		return double(highest(i < buckets ? i : buckets - 1)) * tick_clock::ns_per_tick();
+	}
+};
+
+/**
+ * a histogram per kind of operation of a basic_lru: get that hits,
+ * get that misses, save of a new key, save of a key that was there,
+ * save whose insert grew the index (timed whole, counted here and
+ * not as an insert), and clear.
+ * start() before an operation, then the recording call for what it
+ * turned out to be.
+ */
+class op_latency{
+public:
+	latency_histogram get_hit, get_miss, save_insert, save_update, expand, clear_all;
+	static uint64_t start(){
+		return tick_clock::ticks();
+	}
+	void hit(uint64_t start){
+		get_hit.record(tick_clock::ticks() - start);
+	}
+	void miss(uint64_t start){
+		get_miss.record(tick_clock::ticks() - start);
+	}
+	void save(uint64_t start, bool update, bool expanded){
+		uint64_t ticks = tick_clock::ticks() - start;
+		(expanded ? expand : update ? save_update : save_insert).record(ticks);
+	}
+	void clear(uint64_t start){
+		clear_all.record(tick_clock::ticks() - start);
+	}
+	void merge(const op_latency &other){
+		get_hit.merge(other.get_hit);
+		get_miss.merge(other.get_miss);
+		save_insert.merge(other.save_insert);
+		save_update.merge(other.save_update);
+		expand.merge(other.expand);
+		clear_all.merge(other.clear_all);
+	}
+	/**
+	 * a table of count, p50, p90, p99, p99.9, p99.99 and max in
+	 * whole ns, a row per operation
+	 */
+	void print(std::ostream &os) const {
+		os << "op count p50 p90 p99 p99.9 p99.99 max\n";
+		each([&os](const char *name, const latency_histogram &h){
+			os << name << " " << h.count();
+			for(double q : quantiles)
+				os << " " << uint64_t(h.percentile(q) + 0.5);
+			os << "\n";
+		});
+	}
+	/**
+	 * the same as one JSON object of objects, no newline
+	 */
+	void print_json(std::ostream &os) const {
+		static const char *const names[] = {"p50", "p90", "p99", "p99.9", "p99.99", "max"};
+		const char *comma = "";
+		os << "{";
+		each([&](const char *name, const latency_histogram &h){
+			os << comma << "\"" << name << "\":{\"count\":" << h.count();
+			for(size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++)
+				os << ",\"" << names[i] << "\":" << uint64_t(h.percentile(quantiles[i]) + 0.5);
+			os << "}";
+			comma = ",";
+		});
+		os << "}";
+	}
+private:
+	static constexpr double quantiles[] = {0.5, 0.9, 0.99, 0.999, 0.9999, 1};
+	template<class F>
+	void each(F f) const {
+		f("get_hit", get_hit);
+		f("get_miss", get_miss);
+		f("save_insert", save_insert);
+		f("save_update", save_update);
+		f("expand", expand);
+		f("clear", clear_all);
+	}
+};
+
+#else
+
+/**
+ * without SJTU_LATENCY nothing is timed or kept
+ */
+class op_latency{
+public:
+	static uint64_t start(){
+		return 0;
+	}
+	void hit(uint64_t){}
+	void miss(uint64_t){}
+	void save(uint64_t, bool, bool){}
+	void clear(uint64_t){}
+	void merge(const op_latency &){}
+	void print(std::ostream &) const {}
+	void print_json(std::ostream &os) const {
+		os << "{}";
+	}
+};
+
+#endif
+
+}
+
+#endif
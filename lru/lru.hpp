@@ -3,6 +3,15 @@
 
 #include "utility.hpp"
 #include "exceptions.hpp"
+#include "node_pool.hpp"
+#include "hashing.hpp"
+#include "robin_hood.hpp"
+#include "swiss_table.hpp"
+#include "policy.hpp"
+#include "weigher.hpp"
+#include "stats.hpp"
+#include "latency.hpp"
+#include "compact_map.hpp"
 #include "class-integer.hpp"
 #include "class-matrix.hpp"
 class Hash {
@@ -25,26 +34,51 @@ public:
 	struct Node{
 		T data;
 		Node *pre, *next;
-		Node(const T& data):data(data), pre(nullptr), next(nullptr){}
+		template<class... Args>
+		Node(Args&&... args):data(std::forward<Args>(args)...), pre(nullptr), next(nullptr){}
 	};
 	Node *head, *tail;
 	size_t s;
+	node_pool<Node> *pool;
+	bool shared_pool; // the pool belongs to someone else, don't release it
 	// --------------------------
-	double_list():head(nullptr), tail(nullptr), s(0){
+	double_list():head(nullptr), tail(nullptr), s(0), pool(nullptr), shared_pool(false){
 	}
-	double_list(const double_list<T> &other){
-        // clear();
-        head = nullptr;
-		tail = nullptr;
+	/**
+	 * take nodes from a pool shared with other lists,
+	 * the pool must outlive this list
+	 */
+	double_list(node_pool<Node> *shared):head(nullptr), tail(nullptr), s(0), pool(shared), shared_pool(true){
+	}
+	double_list(const double_list<T> &other):head(nullptr), tail(nullptr), s(0), pool(nullptr), shared_pool(false){
 		Node *tmp = other.head;
 		while(tmp) {
 			insert_tail(tmp->data);
 			tmp = tmp->next;
 		}
-        s = other.s;
     }
+	double_list(const double_list<T> &other, node_pool<Node> *shared):head(nullptr), tail(nullptr), s(0), pool(shared), shared_pool(true){
+		Node *tmp = other.head;
+		while(tmp) {
+			insert_tail(tmp->data);
+			tmp = tmp->next;
+		}
+	}
+	double_list & operator=(const double_list<T> &other){
+		if(this != &other) {
+			clear();
+			Node *tmp = other.head;
+			while(tmp) {
+				insert_tail(tmp->data);
+				tmp = tmp->next;
+			}
+		}
+		return *this;
+	}
 	~double_list(){
 		clear();
+		if(!shared_pool)
+			delete pool;
 	}
 
 	class iterator{
@@ -169,7 +203,7 @@ public:
 		else 
 			tail = tmp->pre;
 		iterator tmp_next = iterator(tmp->next);
-		delete tmp;
+		free_node(tmp);
 		s--;
 		return tmp_next;
 	}
@@ -178,7 +212,7 @@ public:
 	 * the following are operations of double list
 	*/
 	void insert_head(const T &val){
-		Node *new_node = new Node(val);
+		Node *new_node = new_node_of(val);
 		if(!head) {
 			head = new_node;
 			tail = new_node;
@@ -190,53 +224,111 @@ public:
 		s++;
 	}
 	void insert_tail(const T &val){
-		Node *new_node = new Node(val);
-		if(!tail) {
-			head = new_node;
-			tail = new_node;
-		}else {
-			tail->next = new_node;
-			new_node->pre = tail;
-			tail = new_node;
-		}
-		s++;
+		emplace_tail(val);
+	}
+	void insert_tail(T &&val){
+		emplace_tail(std::move(val));
+	}
+	/**
+	 * construct the new tail element right in its node
+	 */
+	template<class... Args>
+	void emplace_tail(Args&&... args){
+		link_tail(new_node_of(std::forward<Args>(args)...));
 	}
 	void delete_head(){
 		if(!head)
 			return;
+		Node* tmp = head;
 		if(s == 1)
 			head = tail = nullptr;
 		else {
-			Node* tmp = head;
 			head = head->next;
 			head->pre = nullptr;
-			s--;
-			delete tmp;
 		}
+		s--;
+		free_node(tmp);
 	}
 	void delete_tail(){
 		if(!tail)
 			return;
+		Node *tmp = tail;
 		if(s == 1)
 			head = tail = nullptr;
 		else {
-			Node *tmp = tail;
 			tail = tail->pre;
 			tail->next = nullptr;
-			s--;
-			delete tmp;
 		}
+		s--;
+		free_node(tmp);
+	}
+	/**
+	 * take the head node out without destroying it, nullptr if empty;
+	 * with link_tail this moves nodes between lists sharing one pool
+	 * without touching their values
+	 */
+	Node *unlink_head(){
+		Node *tmp = head;
+		if(!tmp)
+			return nullptr;
+		head = tmp->next;
+		if(head)
+			head->pre = nullptr;
+		else
+			tail = nullptr;
+		tmp->next = nullptr;
+		s--;
+		return tmp;
+	}
+	void link_tail(Node *node){
+		node->next = nullptr;
+		node->pre = tail;
+		if(tail)
+			tail->next = node;
+		else
+			head = node;
+		tail = node;
+		s++;
+	}
+	/**
+	 * move the element pos points at to the tail in O(1),
+	 * the node is relinked, so pos stays valid
+	 */
+	void splice_to_tail(iterator pos){
+		Node *node = pos.current;
+		if(!node)
+			throw std::out_of_range("invalid");
+		if(node == tail)
+			return;
+		if(node->pre)
+			node->pre->next = node->next;
+		else
+			head = node->next;
+		node->next->pre = node->pre;
+		node->pre = tail;
+		node->next = nullptr;
+		tail->next = node;
+		tail = node;
 	}
 	bool empty () const{
 		return s == 0;
 	}
+	/**
+	 * a list with its own pool gives back all slabs at once,
+	 * a list on a shared pool returns its nodes one by one
+	 */
 	void clear() {
 		Node* tmp = head;
 		while(tmp) {
 			Node* tmp_aft = tmp;
 			tmp = tmp->next;
-			delete tmp_aft;
+			if(shared_pool)
+				free_node(tmp_aft);
+			else
+				tmp_aft->~Node();
 		}
+		if(pool && !shared_pool)
+			pool->release();
 		head = nullptr;
 		tail = nullptr;
 		s = 0;
@@ -250,45 +342,73 @@ public:
 		std::cout << std::endl;
 	}
 	size_t size() const { return s; }
+private:
+	template<class... Args>
+	Node *new_node_of(Args&&... args){
+		if(!pool)
+			pool = new node_pool<Node>();
+		Node *p = pool->allocate();
+		try {
+			return new (p) Node(std::forward<Args>(args)...);
+		}catch(...) {
+			pool->deallocate(p);
+			throw;
+		}
+	}
+	void free_node(Node *p){
+		p->~Node();
+		pool->deallocate(p);
+	}
 };
 
-static const int initial_size = 10;
+/**
+ * Table is a basic_chained_table<Hashing> here,
+ * the open addressing tables are the specializations below
+ */
 template<
 	class Key,
 	class T,
 	class Hash = std::hash<Key>, 
-	class Equal = std::equal_to<Key>
+	class Equal = std::equal_to<Key>,
+	class Table = chained_table
 > class hashmap{
+	typedef typename Table::hashing hashing;
 public:
 	using value_type = pair<const Key, T>;
+	using Node = typename double_list<value_type>::Node;
+	node_pool<Node> pool; // shared by all buckets
 	std::vector<double_list<value_type>*> bucket;
+	// incremental tables only: the doubled buckets while a rehash runs,
+	// bucket[0, rehash_index) are moved over already
+	std::vector<double_list<value_type>*> rehash_bucket;
+	size_t rehash_index;
 	size_t size; // record the number of elements
 	Hash hash_function;
 	Equal equal_function; 
 // --------------------------
 	hashmap() {
 		size = 0;
-		bucket = std::vector<double_list<value_type> *>(initial_size, nullptr);
+		rehash_index = 0;
+		bucket = std::vector<double_list<value_type> *>(hashing::initial_buckets, nullptr);
 	}
 	hashmap(const hashmap &other){
 		size = other.size;
+		rehash_index = other.rehash_index;
 		equal_function = other.equal_function;
 		hash_function = other.hash_function;
-		bucket.resize(other.bucket.size(), nullptr);
-		for(size_t i = 0; i < other.bucket.size(); i++) 
-			if(other.bucket[i])
-				bucket[i] = new double_list<value_type>(*other.bucket[i]);
+		copy_buckets(bucket, other.bucket);
+		copy_buckets(rehash_bucket, other.rehash_bucket);
 	}
 	~hashmap() { clear(); }
 	hashmap & operator=(const hashmap &other){
 		if(this != &other) {
 			clear();
 			size = other.size;
+			rehash_index = other.rehash_index;
 			equal_function = other.equal_function;
 			hash_function = other.hash_function;
-			for(size_t i = 0; i < other.bucket.size(); i++)
-				if(other.bucket[i])
-					bucket[i] = new double_list<value_type>(*other.bucket[i]);
+			copy_buckets(bucket, other.bucket);
+			copy_buckets(rehash_bucket, other.rehash_bucket);
 		}
 		return *this;
 	}
@@ -343,30 +463,50 @@ public:
                 bucket[i] = nullptr;
             }
 		}
+		if(rehashing()) {
+			// the doubled table takes over, nothing is left to move
+			for(size_t i = 0; i < rehash_bucket.size(); i++)
+				if(rehash_bucket[i]) {
+					rehash_bucket[i]->clear();
+					delete rehash_bucket[i];
+					rehash_bucket[i] = nullptr;
+				}
+			bucket.swap(rehash_bucket);
+			std::vector<double_list<value_type> *>().swap(rehash_bucket);
+			rehash_index = 0;
+		}
+		pool.release();
 		// bucket.clear();
 		// bucket.resize(initial_size, nullptr);
 		size = 0;
 	}
 	/**
 	 * you need to expand the hashmap dynamically
+	 * (an incremental table finishes its running rehash first)
 	*/
 	void expand(){
+		while(rehashing())
+			rehash_step();
 		size_t new_size = 2 * bucket.size();
 		std::vector<double_list<value_type> *> new_bucket(new_size, nullptr);
+		// nodes are relinked, not copied; bucket[0, spare) keeps the
+		// drained lists, which are handed out again as new buckets
+		size_t spare = 0;
 		for (size_t i = 0; i < bucket.size(); i++) {
-			if(bucket[i] == nullptr)
+			double_list<value_type> *list = bucket[i];
+			bucket[i] = nullptr;
+			if(list == nullptr)
 				continue;
-			for (auto it = bucket[i]->begin(); it != bucket[i]->end(); it++) {
-				size_t hash_value = hash_function(it->first) % new_size;
+			while (Node *node = list->unlink_head()) {
+				size_t hash_value = hashing::index(hash_function(node->data.first), new_size);
 				if (!new_bucket[hash_value]) 
-					new_bucket[hash_value] = new double_list<value_type>();
-				new_bucket[hash_value]->insert_tail(*it);
+					new_bucket[hash_value] = spare ? bucket[--spare] : new double_list<value_type>(&pool);
+				new_bucket[hash_value]->link_tail(node);
 			}
-			bucket[i]->clear();
-			delete bucket[i];
-			bucket[i] = nullptr;
+			bucket[spare++] = list;
 		}
-		bucket.clear();
+		for (size_t i = 0; i < spare; i++)
+			delete bucket[i];
 		bucket = std::move(new_bucket);
 	}
 
@@ -385,16 +525,11 @@ public:
 	iterator find(const Key &key)const{
 		if(bucket.empty())
 			return end();
-		size_t index = hash_function(key) % bucket.size();
-        if (bucket[index]) {
-            for (auto it = bucket[index]->begin(); it != bucket[index]->end(); it++) {
-                if (equal_function(it->first, key)) {
-                    return iterator(const_cast<double_list<value_type>**>(bucket.data()) + index,
-					const_cast<double_list<value_type>**>(bucket.data()) + bucket.size(), it.current);
-                }
-            }
-        }
-        return end();
+		size_t hash_value = hash_function(key);
+		iterator it = find_in(bucket, key, hash_value);
+		if(it == end() && rehashing())
+			return find_in(rehash_bucket, key, hash_value);
+		return it;
 	}
 	/**
 	 * already have a value_pair with the same key
@@ -407,76 +542,574 @@ public:
 		if(tmp_it != end()) {
 			tmp_it->second = value_pair.second;
 			return sjtu::pair(tmp_it, false);
-		}else {
-			size_t index = hash_function(value_pair.first) % bucket.size();
-			if(!bucket[index]) {
-				bucket[index] = new double_list<value_type>();
-			}
-			bucket[index]->insert_tail(value_pair);
-			size++;
-			typename double_list<value_type>::Node* inserted_node = bucket[index]->tail;
-			if(size > bucket.size()) {
-				expand();
-				index = hash_function(value_pair.first) % bucket.size();
-				inserted_node = bucket[index]->tail;
-			}	
-			return pair(iterator(bucket.data() + index, bucket.data() + bucket.size(), inserted_node), true);
 		}
+		return sjtu::pair(link_new(new_node_of(value_pair)), true);
+	}
+	sjtu::pair<iterator,bool> insert(value_type &&value_pair){
+		iterator tmp_it = find(value_pair.first);
+		if(tmp_it != end()) {
+			tmp_it->second = std::move(value_pair.second);
+			return sjtu::pair(tmp_it, false);
+		}
+		return sjtu::pair(link_new(new_node_of(std::move(value_pair))), true);
+	}
+	/**
+	 * build the value_pair from args right in a new node, then
+	 * the same as insert: an existing key takes the new value
+	 */
+	template<class... Args>
+	sjtu::pair<iterator,bool> emplace(Args&&... args){
+		Node *node = new_node_of(std::forward<Args>(args)...);
+		iterator tmp_it = find(node->data.first);
+		if(tmp_it != end()) {
+			tmp_it->second = std::move(node->data.second);
+			free_node(node);
+			return sjtu::pair(tmp_it, false);
+		}
+		return sjtu::pair(link_new(node), true);
+	}
+	/**
+	 * insert (key, T(args...)) only if key is not there yet,
+	 * otherwise args are left untouched and false returned
+	 */
+	template<class... Args>
+	sjtu::pair<iterator,bool> try_emplace(const Key &key, Args&&... args){
+		iterator tmp_it = find(key);
+		if(tmp_it != end())
+			return sjtu::pair(tmp_it, false);
+		return sjtu::pair(link_new(new_node_of(key, T(std::forward<Args>(args)...))), true);
 	}
 	/**
 	 * the value_pair exists, remove and return true
 	 * otherwise, return false
+	 * an emptied bucket list is kept for the next insert,
+	 * clear() and expand() are the ones that free it
 	*/
 	bool remove(const Key &key){
 		iterator tmp_it = find(key);
 		if(tmp_it == end() || tmp_it.current_node == nullptr) 
 			return false;
-		size_t index = hash_function(key) % bucket.size();
-		if(bucket[index]) {
-			bucket[index]->erase(tmp_it.current_node);
-			size--;
-			if(bucket[index]->empty()) {
-				delete bucket[index];
-				bucket[index] = nullptr;
+		(*tmp_it.bucket_ptr)->erase(tmp_it.current_node);
+		size--;
+		if(rehashing())
+			rehash_step();
+		return true;
+	}
+
+	bool rehashing() const {
+		return !rehash_bucket.empty();
+	}
+private:
+	template<class... Args>
+	Node *new_node_of(Args&&... args){
+		Node *node = pool.allocate();
+		try {
+			return new (node) Node(std::forward<Args>(args)...);
+		}catch(...) {
+			pool.deallocate(node);
+			throw;
+		}
+	}
+	void free_node(Node *node){
+		node->~Node();
+		pool.deallocate(node);
+	}
+	/**
+	 * put a new node, whose key is not in the map yet, into its bucket
+	 */
+	iterator link_new(Node *node){
+		const Key &key = node->data.first;
+		if(Table::incremental) {
+			if(rehashing())
+				rehash_step();
+			// new elements go to the doubled table once a rehash runs
+			std::vector<double_list<value_type> *> &table = rehashing() ? rehash_bucket : bucket;
+			size_t index = hashing::index(hash_function(key), table.size());
+			if(!table[index]) {
+				table[index] = new double_list<value_type>(&pool);
 			}
+			table[index]->link_tail(node);
+			size++;
+			iterator inserted(table.data() + index, table.data() + table.size(), node);
+			if(!rehashing() && size > bucket.size()) {
+				// start moving from the next operation on
+				rehash_bucket.assign(2 * bucket.size(), nullptr);
+				rehash_index = 0;
+			}
+			return inserted;
+		}
+		size_t index = hashing::index(hash_function(key), bucket.size());
+		if(!bucket[index]) {
+			bucket[index] = new double_list<value_type>(&pool);
 		}
+		bucket[index]->link_tail(node);
+		size++;
+		if(size > bucket.size()) {
+			// expand() relinks, node stays where it is
+			expand();
+			index = hashing::index(hash_function(key), bucket.size());
+		}
+		return iterator(bucket.data() + index, bucket.data() + bucket.size(), node);
+	}
+	iterator find_in(const std::vector<double_list<value_type> *> &table, const Key &key, size_t hash_value) const {
+		size_t index = hashing::index(hash_value, table.size());
+		double_list<value_type> **data = const_cast<double_list<value_type> **>(table.data());
+        if (table[index]) {
+            for (auto it = table[index]->begin(); it != table[index]->end(); it++) {
+                if (equal_function(it->first, key)) {
+                    return iterator(data + index, data + table.size(), it.current);
+                }
+            }
+        }
+        return end();
+	}
+	void copy_buckets(std::vector<double_list<value_type> *> &to, const std::vector<double_list<value_type> *> &from){
+		to.assign(from.size(), nullptr);
+		for(size_t i = 0; i < from.size(); i++)
+			if(from[i])
+				to[i] = new double_list<value_type>(*from[i], &pool);
+	}
+	/**
+	 * move one non-empty old bucket to the doubled table, looking at
+	 * no more than Table::empty_visits empty ones on the way;
+	 * the doubled table takes over once every bucket is moved
+	 */
+	void rehash_step(){
+		for(size_t visits = 0; rehash_index < bucket.size(); rehash_index++) {
+			double_list<value_type> *list = bucket[rehash_index];
+			if(!list || list->empty()) {
+				if(list) {
+					delete list;
+					bucket[rehash_index] = nullptr;
+				}
+				if(++visits == Table::empty_visits) {
+					rehash_index++;
+					break;
+				}
+				continue;
+			}
+			while (Node *node = list->unlink_head()) {
+				size_t index = hashing::index(hash_function(node->data.first), rehash_bucket.size());
+				if (!rehash_bucket[index]) 
+					rehash_bucket[index] = new double_list<value_type>(&pool);
+				rehash_bucket[index]->link_tail(node);
+			}
+			delete list;
+			bucket[rehash_index++] = nullptr;
+			break;
+		}
+		if(rehash_index == bucket.size()) {
+			bucket.swap(rehash_bucket);
+			std::vector<double_list<value_type> *>().swap(rehash_bucket);
+			rehash_index = 0;
+		}
+	}
+};
+
+/**
+ * the hashmap on an open addressing Core (robin_hood_core, swiss_core):
+ * the value_pairs sit right in the slot array, so a hit costs one
+ * probe into contiguous memory.
+ * any insert or remove may move other elements, so every iterator
+ * is invalidated by it.
+ */
+template<class Key, class T, class Core>
+class open_hashmap :public Core{
+public:
+	using value_type = pair<const Key, T>;
+	class iterator{
+	public:
+		value_type *current;
+		// --------------------------
+		iterator():current(nullptr){}
+		iterator(value_type *t):current(t){}
+		value_type &operator*() const {
+			if(!current)
+				throw std::out_of_range("point to nothing");
+			return *current;
+		}
+		value_type *operator->() const noexcept {
+			return current;
+		}
+		bool operator==(const iterator &rhs) const {
+			return current == rhs.current;
+		}
+		bool operator!=(const iterator &rhs) const {
+			return current != rhs.current;
+		}
+	};
+    /**
+     * the iterator point at nothing
+    */
+	iterator end() const {
+		return iterator(nullptr);
+	}
+	iterator find(const Key &key) const {
+		size_t index = this->find_index(key);
+		if(index == Core::npos)
+			return end();
+		return iterator(this->slots + index);
+	}
+	/**
+	 * already have a value_pair with the same key
+	 * -> just update the value, return false
+	 * not find a value_pair with the same key
+	 * -> insert the value_pair, return true
+	*/
+	sjtu::pair<iterator,bool> insert(const value_type &value_pair){
+		size_t index = this->find_index(value_pair.first);
+		if(index != Core::npos) {
+			this->slots[index].second = value_pair.second;
+			return sjtu::pair(iterator(this->slots + index), false);
+		}
+		index = this->insert_new(value_type(value_pair));
+		return sjtu::pair(iterator(this->slots + index), true);
+	}
+	sjtu::pair<iterator,bool> insert(value_type &&value_pair){
+		size_t index = this->find_index(value_pair.first);
+		if(index != Core::npos) {
+			this->slots[index].second = std::move(value_pair.second);
+			return sjtu::pair(iterator(this->slots + index), false);
+		}
+		index = this->insert_new(std::move(value_pair));
+		return sjtu::pair(iterator(this->slots + index), true);
+	}
+	/**
+	 * the slots are probed by key before the value_pair has a
+	 * place, so it is built once here and then moved into its slot
+	 */
+	template<class... Args>
+	sjtu::pair<iterator,bool> emplace(Args&&... args){
+		return insert(value_type(std::forward<Args>(args)...));
+	}
+	template<class... Args>
+	sjtu::pair<iterator,bool> try_emplace(const Key &key, Args&&... args){
+		size_t index = this->find_index(key);
+		if(index != Core::npos)
+			return sjtu::pair(iterator(this->slots + index), false);
+		index = this->insert_new(value_type(key, T(std::forward<Args>(args)...)));
+		return sjtu::pair(iterator(this->slots + index), true);
+	}
+	/**
+	 * the value_pair exists, remove and return true
+	 * otherwise, return false
+	*/
+	bool remove(const Key &key){
+		size_t index = this->find_index(key);
+		if(index == Core::npos)
+			return false;
+		this->erase_at(index);
 		return true;
 	}
 };
 
+template<class Key, class T, class Hash, class Equal>
+class hashmap<Key, T, Hash, Equal, robin_hood_table>
+	:public open_hashmap<Key, T, robin_hood_core<pair<const Key, T>, Key, pair_key, Hash, Equal>>{};
+
+template<class Key, class T, class Hash, class Equal>
+class hashmap<Key, T, Hash, Equal, swiss_table>
+	:public open_hashmap<Key, T, swiss_core<pair<const Key, T>, Key, pair_key, Hash, Equal>>{};
+
+/**
+ * the key -> node index behind linked_hashmap, picked by the table tag
+ */
+template<class Node, class Key, class Hash, class Equal, class Table>
+class node_index;
+
+/**
+ * chained tables: the nodes of a bucket are linked through Node::chain
+ */
+template<class Node, class Key, class Hash, class Equal, class Hashing, bool Incremental>
+class node_index<Node, Key, Hash, Equal, basic_chained_table<Hashing, Incremental>>{
+	typedef basic_chained_table<Hashing, Incremental> table;
+public:
+	std::vector<Node *> bucket;
+	// incremental tables only: the doubled buckets while a rehash runs,
+	// bucket[0, rehash_index) are moved over already
+	std::vector<Node *> rehash_bucket;
+	size_t rehash_index;
+	size_t size;
+	size_t expansions; // times the buckets were doubled (or began to be)
+	Hash hash_function;
+	Equal equal_function;
+	// --------------------------
+	node_index():bucket(Hashing::initial_buckets, nullptr), rehash_index(0), size(0), expansions(0){}
+	node_index(const node_index &) = delete;
+	node_index & operator=(const node_index &) = delete;
+
+	Node *find(const Key &key) const {
+		size_t hash_value;
+		return find(key, hash_value);
+	}
+	/**
+	 * the same, and hash_value keeps the hash of key,
+	 * for a link(node, hash_value) after a miss
+	 */
+	Node *find(const Key &key, size_t &hash_value) const {
+		hash_value = hash_function(key);
+		return find_hashed(key, hash_value);
+	}
+	/**
+	 * find with the hash of key already known
+	 */
+	Node *find_hashed(const Key &key, size_t hash_value) const {
+		for(Node *tmp = bucket[Hashing::index(hash_value, bucket.size())]; tmp; tmp = tmp->chain)
+			if(equal_function(tmp->data.first, key))
+				return tmp;
+		if(rehashing())
+			for(Node *tmp = rehash_bucket[Hashing::index(hash_value, rehash_bucket.size())]; tmp; tmp = tmp->chain)
+				if(equal_function(tmp->data.first, key))
+					return tmp;
+		return nullptr;
+	}
+	/**
+	 * for the batched lookups, a few keys ahead: bring the bucket of
+	 * hash_value into the cache, and later the first node in it
+	 */
+	void prefetch_bucket(size_t hash_value) const {
+		__builtin_prefetch(&bucket[Hashing::index(hash_value, bucket.size())]);
+	}
+	void prefetch_node(size_t hash_value) const {
+		Node *node = candidate(hash_value);
+		if(node)
+			__builtin_prefetch(node);
+	}
+	/**
+	 * the node a lookup of hash_value compares first, nullptr for an
+	 * empty bucket; no key is compared
+	 */
+	Node *candidate(size_t hash_value) const {
+		return bucket[Hashing::index(hash_value, bucket.size())];
+	}
+	/**
+	 * link a node whose key is not in the index yet
+	 */
+	void link(Node *node){
+		link(node, hash_function(node->data.first));
+	}
+	void link(Node *node, size_t hash_value){
+		if(rehashing())
+			rehash_step();
+		std::vector<Node *> &to = rehashing() ? rehash_bucket : bucket;
+		size_t index = Hashing::index(hash_value, to.size());
+		node->chain = to[index];
+		to[index] = node;
+		if(++size > bucket.size() && !rehashing()) {
+			expansions++;
+			if(Incremental) {
+				rehash_bucket.assign(2 * bucket.size(), nullptr);
+				rehash_index = 0;
+			}else
+				expand();
+		}
+	}
+	void unlink(Node *node){
+		size_t hash_value = hash_function(node->data.first);
+		Node **link = &bucket[Hashing::index(hash_value, bucket.size())];
+		while(*link && *link != node)
+			link = &(*link)->chain;
+		if(!*link)
+			link = &rehash_bucket[Hashing::index(hash_value, rehash_bucket.size())];
+		while(*link != node)
+			link = &(*link)->chain;
+		*link = node->chain;
+		size--;
+		if(rehashing())
+			rehash_step();
+	}
+	void clear(){
+		if(rehashing()) {
+			bucket.swap(rehash_bucket);
+			std::vector<Node *>().swap(rehash_bucket);
+			rehash_index = 0;
+		}
+		for(size_t i = 0; i < bucket.size(); i++)
+			bucket[i] = nullptr;
+		size = 0;
+	}
+	/**
+	 * double the buckets and relink every node,
+	 * no node is copied or reallocated
+	 * (an incremental index finishes its running rehash first)
+	 */
+	void expand(){
+		while(rehashing())
+			rehash_step();
+		size_t new_size = 2 * bucket.size();
+		std::vector<Node *> new_bucket(new_size, nullptr);
+		for(size_t i = 0; i < bucket.size(); i++) {
+			Node *tmp = bucket[i];
+			while(tmp) {
+				Node *tmp_aft = tmp->chain;
+				size_t index = Hashing::index(hash_function(tmp->data.first), new_size);
+				tmp->chain = new_bucket[index];
+				new_bucket[index] = tmp;
+				tmp = tmp_aft;
+			}
+		}
+		bucket = std::move(new_bucket);
+	}
+	bool rehashing() const {
+		return !rehash_bucket.empty();
+	}
+private:
+	/**
+	 * relink one non-empty old bucket into the doubled table, looking
+	 * at no more than table::empty_visits empty ones on the way;
+	 * the doubled table takes over once every bucket is moved
+	 */
+	void rehash_step(){
+		for(size_t visits = 0; rehash_index < bucket.size(); rehash_index++) {
+			Node *tmp = bucket[rehash_index];
+			if(!tmp) {
+				if(++visits == table::empty_visits) {
+					rehash_index++;
+					break;
+				}
+				continue;
+			}
+			while(tmp) {
+				Node *tmp_aft = tmp->chain;
+				size_t index = Hashing::index(hash_function(tmp->data.first), rehash_bucket.size());
+				tmp->chain = rehash_bucket[index];
+				rehash_bucket[index] = tmp;
+				tmp = tmp_aft;
+			}
+			bucket[rehash_index++] = nullptr;
+			break;
+		}
+		if(rehash_index == bucket.size()) {
+			bucket.swap(rehash_bucket);
+			std::vector<Node *>().swap(rehash_bucket);
+			rehash_index = 0;
+		}
+	}
+};
+
+/**
+ * open addressing tables hold node pointers in their slots
+ */
+template<class Node, class Key, class Core>
+class open_node_index :public Core{
+public:
+	open_node_index(){}
+	open_node_index(const open_node_index &) = delete;
+	open_node_index & operator=(const open_node_index &) = delete;
+
+	Node *find(const Key &key) const {
+		size_t index = this->find_index(key);
+		return index == Core::npos ? nullptr : this->slots[index];
+	}
+	Node *find(const Key &key, size_t &hash_value) const {
+		hash_value = this->hash_function(key);
+		return find_hashed(key, hash_value);
+	}
+	Node *find_hashed(const Key &key, size_t hash_value) const {
+		size_t index = Core::find_hashed(hash_value, [&](const Node *slot){ return this->equal_function(slot->data.first, key); });
+		return index == Core::npos ? nullptr : this->slots[index];
+	}
+	void prefetch_bucket(size_t hash_value) const {
+		this->prefetch(hash_value);
+	}
+	/**
+	 * every node on the probe sequence that may hold the key
+	 */
+	void prefetch_node(size_t hash_value) const {
+		Core::find_hashed(hash_value, [](const Node *slot){
+			__builtin_prefetch(slot);
+			return false;
+		});
+	}
+	/**
+	 * the first node on the probe sequence whose hash tag matches
+	 */
+	Node *candidate(size_t hash_value) const {
+		size_t index = Core::find_hashed(hash_value, [](const Node *){ return true; });
+		return index == Core::npos ? nullptr : this->slots[index];
+	}
+	void link(Node *node){
+		this->insert_new(static_cast<Node *>(node));
+	}
+	void link(Node *node, size_t hash_value){
+		this->insert_hashed(hash_value, static_cast<Node *>(node));
+	}
+	void unlink(Node *node){
+		this->erase_at(this->find_if(node->data.first, [node](Node *slot){ return slot == node; }));
+	}
+};
+
+template<class Node, class Key, class Hash, class Equal>
+class node_index<Node, Key, Hash, Equal, robin_hood_table>
+	:public open_node_index<Node, Key, robin_hood_core<Node *, Key, node_key, Hash, Equal>>{};
+
+template<class Node, class Key, class Hash, class Equal>
+class node_index<Node, Key, Hash, Equal, swiss_table>
+	:public open_node_index<Node, Key, swiss_core<Node *, Key, node_key, Hash, Equal>>{};
+
+/**
+ * an intrusive linked hashmap:
+ * every element lives in one node which carries the value_pair,
+ * the link to the next node of its bucket and the pre/next links
+ * of the inserting order, so the key is stored only once and
+ * find/insert/remove touch a single node.
+ * Table picks the key -> node index (see node_index).
+ * every node also carries a Meta (empty by default, costing no
+ * space), the per-element state of an eviction policy.
+ */
 template<
 	class Key,
 	class T,
 	class Hash = std::hash<Key>, 
-	class Equal = std::equal_to<Key>
-> class linked_hashmap :public hashmap<Key,T,Hash,Equal>{
+	class Equal = std::equal_to<Key>,
+	class Table = chained_table,
+	class Meta = no_meta
+> class linked_hashmap{
 public:
 	typedef pair<const Key, T> value_type;
-	double_list<value_type> order;
-	hashmap<Key, typename double_list<value_type>::iterator, Hash, Equal> map;
+	/**
+	 * the same kind of map with another value and meta type
+	 */
+	template<class U, class M = no_meta>
+	using rebind = linked_hashmap<Key, U, Hash, Equal, Table, M>;
+	struct Node :public Meta{
+		value_type data;
+		Node *pre, *next; // inserting order
+		Node *chain; // next node in the same bucket, chained tables only
+		template<class... Args>
+		Node(Args&&... args):data(std::forward<Args>(args)...), pre(nullptr), next(nullptr), chain(nullptr){}
+	};
+	node_pool<Node> pool;
+	node_index<Node, Key, Hash, Equal, Table> index;
+	Node *head, *tail;
+	size_t s;
 	// --------------------------
 	class const_iterator;
 	class iterator{
 	public:
-		typename double_list<value_type>::iterator it;
+		Node *current;
 		// --------------------------
-		iterator(){}
-		iterator(typename double_list<value_type>::iterator it):it(it) {}
-		iterator(const iterator &other):it(other.it){}
+		iterator():current(nullptr){}
+		iterator(Node *t):current(t) {}
+		iterator(const iterator &other):current(other.current){}
 		~iterator(){}
 		/**
 		 * iter++
 		 */
 		iterator operator++(int) {
 			iterator old = *this;
-			it++;
+			if(!current)
+				throw std::out_of_range("invalid++");
+			current = current->next;
 			return old;
 		}
 		/**
 		 * ++iter
 		 */
 		iterator &operator++() {
-			it++;
+			if(!current)
+				throw std::out_of_range("++invalid");
+			current = current->next;
 			return *this;
 		}
 		/**
@@ -484,14 +1117,18 @@ public:
 		 */
 		iterator operator--(int) {
 			iterator old = *this;
-			it--;
+			if(!current || !(current->pre))
+				throw std::out_of_range("invalid--");
+			current = current->pre;
 			return old;
 		}
 		/**
 		 * --iter
 		 */
 		iterator &operator--() {
-			it--;
+			if(!current || !(current->pre))
+				throw std::out_of_range("--invalid");
+			current = current->pre;
 			return *this;
 		}
 
@@ -500,41 +1137,47 @@ public:
 		 * throw "star invalid"
 		*/
 		value_type &operator*() const {
-			return *it;
+			if(!current)
+				throw std::out_of_range("invalid");
+			return current->data;
 		}
 		value_type *operator->() const noexcept {
-			return &(*it);
+			return &(current->data);
 		}
 
 		/**
 		 * operator to check whether two iterators are same (pointing to the same memory).
 		 */
-		bool operator==(const iterator &rhs) const {return it == rhs.it;}
-		bool operator!=(const iterator &rhs) const {return it != rhs.it;}
-		bool operator==(const const_iterator &rhs) const {return it == rhs.it;}
-		bool operator!=(const const_iterator &rhs) const {return it != rhs.it;}
+		bool operator==(const iterator &rhs) const {return current == rhs.current;}
+		bool operator!=(const iterator &rhs) const {return current != rhs.current;}
+		bool operator==(const const_iterator &rhs) const {return current == rhs.current;}
+		bool operator!=(const const_iterator &rhs) const {return current != rhs.current;}
 	};
  
 	class const_iterator {
 		public:
-			typename double_list<value_type>::iterator it;
+			const Node *current;
     // --------------------------   
-		const_iterator() {}
-		const_iterator(typename double_list<value_type>::iterator it):it(it) {}
-		const_iterator(const iterator &other):it(other.it){}
+		const_iterator():current(nullptr) {}
+		const_iterator(const Node *t):current(t) {}
+		const_iterator(const iterator &other):current(other.current){}
 		/**
 		 * iter++
 		 */
 		const_iterator operator++(int) {
 			const_iterator old = *this;
-			it++;
+			if(!current)
+				throw std::out_of_range("invalid++");
+			current = current->next;
 			return old;
 		}
 		/**
 		 * ++iter
 		 */
 		const_iterator &operator++() {
-			it++;
+			if(!current)
+				throw std::out_of_range("++invalid");
+			current = current->next;
 			return *this;
 		}
 		/**
@@ -542,14 +1185,18 @@ public:
 		 */
 		const_iterator operator--(int) {
 			const_iterator old = *this;
-			it--;
+			if(!current || !(current->pre))
+				throw std::out_of_range("invalid--");
+			current = current->pre;
 			return old;
 		}
 		/**
 		 * --iter
 		 */
 		const_iterator &operator--() {
-			it--;
+			if(!current || !(current->pre))
+				throw std::out_of_range("--invalid");
+			current = current->pre;
 			return *this;
 		}
 
@@ -558,37 +1205,40 @@ public:
 		 * throw 
 		*/
 		const value_type &operator*() const {
-			return *it;
+			if(!current)
+				throw std::out_of_range("invalid");
+			return current->data;
 		}
 		const value_type *operator->() const noexcept {
-			return &(*it);
+			return &(current->data);
 		}
 
 		/**
 		 * operator to check whether two iterators are same (pointing to the same memory).
 		 */
-		bool operator==(const iterator &rhs) const { return it == rhs.it; }
-		bool operator!=(const iterator &rhs) const { return it != rhs.it; }
-		bool operator==(const const_iterator &rhs) const { return it == rhs.it; }
-		bool operator!=(const const_iterator &rhs) const { return it != rhs.it; }
+		bool operator==(const iterator &rhs) const { return current == rhs.current; }
+		bool operator!=(const iterator &rhs) const { return current != rhs.current; }
+		bool operator==(const const_iterator &rhs) const { return current == rhs.current; }
+		bool operator!=(const const_iterator &rhs) const { return current != rhs.current; }
 	};
  
-	linked_hashmap() {}
-	linked_hashmap(const linked_hashmap &other):map(other.map){
-		for(auto it = other.order.begin(); it != other.order.end(); it++)
-			order.insert_tail(*it);
+	linked_hashmap():head(nullptr), tail(nullptr), s(0) {}
+	linked_hashmap(const linked_hashmap &other):head(nullptr), tail(nullptr), s(0) {
+		index.hash_function = other.index.hash_function;
+		index.equal_function = other.index.equal_function;
+		for(Node *tmp = other.head; tmp; tmp = tmp->next)
+			insert(tmp->data);
 	}
 	~linked_hashmap() {
-		order.clear();
-		map.clear();
+		clear();
 	}
 	linked_hashmap & operator=(const linked_hashmap &other) {
 		if(this != &other) {
-			map.clear();
-			map = other.map;
-			order.clear();
-			for(auto it = other.order.begin(); it != other.order.end(); it++) 
-				order.insert_tail(*it);
+			clear();
+			index.hash_function = other.index.hash_function;
+			index.equal_function = other.index.equal_function;
+			for(Node *tmp = other.head; tmp; tmp = tmp->next)
+				insert(tmp->data);
 		}
 		return *this;
 	}
@@ -598,28 +1248,22 @@ public:
 	 * if the key not found, throw 
 	*/
 	T & at(const Key &key) {
-		auto it = map.find(key);
-		if(it == map.end())
+		Node *node = index.find(key);
+		if(!node)
 			throw std::out_of_range("key is not valid");
-		return it->second->second;
+		return node->data.second;
 	}
 	const T & at(const Key &key) const {
-		auto it = map.find(key);
-		if(it == map.end())
+		Node *node = index.find(key);
+		if(!node)
 			throw std::out_of_range("key is not valid");
-		return it->second->second;
+		return node->data.second;
 	}
 	T & operator[](const Key &key) {
-		auto it = map.find(key);
-		if(it == map.end())
-			throw std::out_of_range("key is not valid");
-		return it->second->second;
+		return at(key);
 	}
 	const T & operator[](const Key &key) const {
-		auto it = map.find(key);
-		if(it == map.end())
-			throw std::out_of_range("key is not valid");
-		return it->second->second;
+		return at(key);
 	}
 
 	/**
@@ -627,35 +1271,51 @@ public:
 	 * inserted and existed element
 	 */
 	iterator begin() {
-		return iterator(order.begin());
+		return iterator(head);
 	}
 	const_iterator cbegin() const {
-		return const_iterator(order.begin());
+		return const_iterator(head);
 	}
     /**
 	 * return an iterator after the last inserted element
 	 */
 	iterator end() {
-		return iterator(order.end());
+		return iterator(nullptr);
 	}
 	const_iterator cend() const {
-		return const_iterator(order.end());
+		return const_iterator(nullptr);
 	}
+	const_iterator begin() const { return cbegin(); }
+	const_iterator end() const { return cend(); }
   	/**
 	 * if didn't contain anything, return true, 
 	 * otherwise false.
 	 */
 	bool empty() const {
-		return order.empty();
+		return s == 0;
 	}
 
     void clear(){
-		order.clear();
-		map.clear();
+		Node *tmp = head;
+		while(tmp) {
+			Node *tmp_aft = tmp;
+			tmp = tmp->next;
+			tmp_aft->~Node();
+		}
+		pool.release();
+		index.clear();
+		head = tail = nullptr;
+		s = 0;
 	}
 
 	size_t size() const {
-		return order.size();
+		return s;
+	}
+	/**
+	 * how many times the index grew
+	 */
+	size_t expansions() const {
+		return index.expansions;
 	}
  	/**
 	 * insert the value_piar
@@ -668,19 +1328,53 @@ public:
 	 * add a new element and return true
 	*/
 	pair<iterator, bool> insert(const value_type &value) {
-		auto it = map.find(value.first);
-		if(it != map.end()) {
-			order.erase(it->second);
-			order.insert_tail(value);
-			auto new_pos = order.get_tail();
-			it->second = new_pos;
-			return sjtu::pair(iterator(new_pos), false);
-		}else {
-			order.insert_tail(value);
-			auto new_it = order.get_tail();
-			map.insert(sjtu::pair(value.first, new_it));
-			return sjtu::pair(iterator(new_it), true);
+		Node *node = index.find(value.first);
+		if(node) {
+			node->data.second = value.second;
+			unlink_order(node);
+			link_tail(node);
+			return sjtu::pair(iterator(node), false);
+		}
+		return sjtu::pair(iterator(link_new(new_node_of(value))), true);
+	}
+	pair<iterator, bool> insert(value_type &&value) {
+		Node *node = index.find(value.first);
+		if(node) {
+			node->data.second = std::move(value.second);
+			unlink_order(node);
+			link_tail(node);
+			return sjtu::pair(iterator(node), false);
+		}
+		return sjtu::pair(iterator(link_new(new_node_of(std::move(value)))), true);
+	}
+	/**
+	 * build the value_pair from args right in a new node, then
+	 * the same as insert: an existing key takes the new value
+	 * and moves to the end
+	 */
+	template<class... Args>
+	pair<iterator, bool> emplace(Args&&... args) {
+		Node *node = new_node_of(std::forward<Args>(args)...);
+		Node *old = index.find(node->data.first);
+		if(old) {
+			old->data.second = std::move(node->data.second);
+			free_node(node);
+			unlink_order(old);
+			link_tail(old);
+			return sjtu::pair(iterator(old), false);
 		}
+		return sjtu::pair(iterator(link_new(node)), true);
+	}
+	/**
+	 * insert (key, T(args...)) only if key is not there yet,
+	 * otherwise nothing changes, not even the order
+	 */
+	template<class... Args>
+	pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+		Node *node = index.find(key);
+		if(node)
+			return sjtu::pair(iterator(node), false);
+		return sjtu::pair(iterator(link_new(new_node_of(key, T(std::forward<Args>(args)...)))), true);
 	}
  	/**
 	 * erase the value_pair pointed by the iterator
@@ -690,17 +1384,132 @@ public:
 	void remove(iterator pos) {
 		if(pos == end())
 			throw std::out_of_range("iterator points to nothing");
-		map.remove(pos->first);
-		order.erase(pos.it);
+		Node *node = pos.current;
+		index.unlink(node);
+		unlink_order(node);
+		free_node(node);
+		s--;
+	}
+	/**
+	 * insert (key, obj), or assign obj to the value of key and move
+	 * it to the end, the same as insert; key is hashed once and the
+	 * index probed once for both
+	 */
+	template<class M>
+	pair<iterator, bool> insert_or_assign(const Key &key, M &&obj) {
+		return insert_or_assign(key, std::forward<M>(obj), size_t(-1));
+	}
+	/**
+	 * the same, but when key is new and there are already limit
+	 * elements, the first one is dropped and its node storage
+	 * holds the new element, so the pool isn't touched
+	 */
+	template<class M>
+	pair<iterator, bool> insert_or_assign(const Key &key, M &&obj, size_t limit) {
+		return insert_or_assign(key, std::forward<M>(obj), limit, hash(key));
+	}
+	/**
+	 * the same, with hash_value = hash(key) computed beforehand
+	 */
+	template<class M>
+	pair<iterator, bool> insert_or_assign(const Key &key, M &&obj, size_t limit, size_t hash_value) {
+		Node *node = index.find_hashed(key, hash_value);
+		if(node) {
+			node->data.second = std::forward<M>(obj);
+			touch(iterator(node));
+			return sjtu::pair(iterator(node), false);
+		}
+		if(s >= limit && head)
+			return sjtu::pair(replace(begin(), key, std::forward<M>(obj), hash_value), true);
+		return sjtu::pair(insert_new(key, std::forward<M>(obj), hash_value), true);
+	}
+	/**
+	 * add (key, obj) at the end of the order, key must not be in
+	 * the map and hash_value = hash(key)
+	 */
+	template<class M>
+	iterator insert_new(const Key &key, M &&obj, size_t hash_value) {
+		Node *node = new_node_of(key, std::forward<M>(obj));
+		index.link(node, hash_value);
+		link_tail(node);
+		s++;
+		return iterator(node);
+	}
+	/**
+	 * the same, but the element at victim is dropped first and its
+	 * node storage holds the new element, so the pool isn't touched
+	 */
+	template<class M>
+	iterator replace(iterator victim, const Key &key, M &&obj, size_t hash_value) {
+		if(victim == end())
+			throw std::out_of_range("iterator points to nothing");
+		Node *node = victim.current;
+		index.unlink(node);
+		unlink_order(node);
+		node->~Node();
+		s--;
+		try {
+			new (node) Node(key, std::forward<M>(obj));
+		}catch(...) {
+			pool.deallocate(node);
+			throw;
+		}
+		index.link(node, hash_value);
+		link_tail(node);
+		s++;
+		return iterator(node);
+	}
+	/**
+	 * make the element pos points at the last one in the order,
+	 * only pointers are relinked and pos stays valid
+	 * if the iterator points to nothing
+	 * throw
+	*/
+	void touch(iterator pos) {
+		if(pos == end())
+			throw std::out_of_range("iterator points to nothing");
+		Node *node = pos.current;
+		if(node == tail)
+			return;
+		unlink_order(node);
+		link_tail(node);
+	}
+	/**
+	 * relink the element pos points at right before where, or at the
+	 * end of the order if where is end(); pos stays valid
+	 */
+	void move_before(iterator pos, iterator where) {
+		if(pos == end())
+			throw std::out_of_range("iterator points to nothing");
+		Node *node = pos.current;
+		if(node == where.current)
+			return;
+		unlink_order(node);
+		if(!where.current) {
+			link_tail(node);
+			return;
+		}
+		Node *next = where.current;
+		node->next = next;
+		node->pre = next->pre;
+		if(next->pre)
+			next->pre->next = node;
+		else
+			head = node;
+		next->pre = node;
+	}
+	/**
+	 * the policy state kept in the node of pos
+	 */
+	Meta &meta(iterator pos) {
+		return *pos.current;
 	}
 	/**
 	 * return how many value_pairs consist of key
 	 * this should only return 0 or 1
 	*/
 	size_t count(const Key &key) const {
-		if(map.find(key) == map.end())
-			return 0;
-		return 1;
+		return index.find(key) ? 1 : 0;
 	}
 	/**
 	 * find the iterator points at the value_pair
@@ -709,47 +1518,227 @@ public:
 	 * point at nothing
 	*/
 	iterator find(const Key &key) {
-		auto it = map.find(key);
-		if(it == map.end())
-			return end();
-		return iterator(it->second);
+		return iterator(index.find(key));
+	}
+	/**
+	 * the same, with hash_value = hash(key) computed beforehand
+	 */
+	iterator find(const Key &key, size_t hash_value) {
+		return iterator(index.find_hashed(key, hash_value));
+	}
+	/**
+	 * the hash the index files key under, so a batch of operations can
+	 * hash every key first and prefetch_bucket / prefetch_node some
+	 * keys ahead of the one it looks up
+	 */
+	size_t hash(const Key &key) const {
+		return index.hash_function(key);
+	}
+	void prefetch_bucket(size_t hash_value) const {
+		index.prefetch_bucket(hash_value);
+	}
+	void prefetch_node(size_t hash_value) const {
+		index.prefetch_node(hash_value);
+	}
+	/**
+	 * once the node prefetch_node fetched is cached: bring its
+	 * neighbours in the order into the cache, a touch writes both.
+	 * that is the node a lookup compares first, usually the one with
+	 * the key; no key is compared here, the lookup itself does that
+	 */
+	void prefetch_order(size_t hash_value) const {
+		Node *node = index.candidate(hash_value);
+		if(node && node->pre)
+			__builtin_prefetch(node->pre, 1);
+		if(node && node->next)
+			__builtin_prefetch(node->next, 1);
 	}
 
+private:
+	template<class... Args>
+	Node *new_node_of(Args&&... args) {
+		Node *node = pool.allocate();
+		try {
+			return new (node) Node(std::forward<Args>(args)...);
+		}catch(...) {
+			pool.deallocate(node);
+			throw;
+		}
+	}
+	void free_node(Node *node) {
+		node->~Node();
+		pool.deallocate(node);
+	}
+	Node *link_new(Node *node) {
+		index.link(node);
+		link_tail(node);
+		s++;
+		return node;
+	}
+	void link_tail(Node *node) {
+		node->pre = tail;
+		node->next = nullptr;
+		if(tail)
+			tail->next = node;
+		else
+			head = node;
+		tail = node;
+	}
+	void unlink_order(Node *node) {
+		if(node->pre)
+			node->pre->next = node->next;
+		else
+			head = node->next;
+		if(node->next)
+			node->next->pre = node->pre;
+		else
+			tail = node->pre;
+	}
 };
 
-class lru{
-    using lmap = sjtu::linked_hashmap<Integer,Matrix<int>,Hash,Equal>;
-    using value_type = sjtu::pair<const Integer, Matrix<int> >;
+template<class Key, class T, class Hash, class Equal, class Meta>
+class linked_hashmap<Key, T, Hash, Equal, compact_table, Meta>
+	:public compact_linked_hashmap<Key, T, Hash, Equal, Meta>{};
+
+/**
+ * keys are printed as they are, Integer by its val
+ */
+template<class Key>
+const Key &printable(const Key &key) { return key; }
+inline int printable(const Integer &key) { return key.val; }
+
+/**
+ * the cache on any key and value type,
+ * Table picks the index of the linked_hashmap under it, Policy
+ * which element is evicted (see policy.hpp), least recently used
+ * by default, and Weigher what an element costs out of c (see
+ * weigher.hpp), 1 by default.
+ * weight is the total of the elements, kept as they come and go.
+ * lru (below) is the Integer -> Matrix<int> one, byte_lru the same
+ * with c in bytes.
+ */
+template<
+	class Key,
+	class T,
+	class Hash = std::hash<Key>,
+	class Equal = std::equal_to<Key>,
+	class Table = chained_table,
+	class Policy = lru_policy,
+	class Weigher = unit_weigher
+> class basic_lru{
+    using lmap = sjtu::linked_hashmap<Key,T,Hash,Equal,Table,typename Policy::meta>;
+    using value_type = sjtu::pair<const Key, T>;
+	static_assert(!is_elements_only<Policy>::value || std::is_same<Weigher, unit_weigher>::value,
+				  "this policy sizes its queues by c as a number of elements");
 public:
+	using iterator = typename lmap::iterator;
 	size_t c;
+	size_t weight;
+	Weigher weigher;
 	mutable lmap map;
-	lru(int size):c(size){}
-    ~lru(){}
+	typename Policy::template hooks<lmap> policy;
+	stats_counters counters;
+	op_latency latency;
+	basic_lru(int size):c(size), weight(0){}
+    ~basic_lru(){}
     /**
      * save the value_pair in the memory
      * delete something in the memory if necessary
     */
     void save(const value_type &v) {
-		if(map.count(v.first)) {
-			map.remove(map.find(v.first));
-		}
-		if(map.size() >= c) {
-			auto ol = map.begin();
-			map.remove(ol);
-		}
-		map.insert(v);
+		store(v.first, v.second, map.hash(v.first));
+	}
+    /**
+     * the same, but the value is moved into the memory
+    */
+    void save(value_type &&v) {
+		store(v.first, std::move(v.second), map.hash(v.first));
 	}
     /**
      * return a pointer contain the value
     */
-    Matrix<int>* get(const Integer &v) {
+    T* get(const Key &v) {
+		uint64_t start = latency.start();
 		auto it = map.find(v);
-		if(it == map.end())
+		if(it == map.end()) {
+			counters.miss();
+			policy.on_miss(*this, v);
+			latency.miss(start);
 			return nullptr;
-		auto value = it->second;
+		}
+		counters.hit();
+		policy.on_hit(*this, it);
+		latency.hit(start);
+		return &(it->second);
+	}
+    /**
+     * drop the element at it as if it were evicted
+    */
+    void remove(iterator it) {
+		policy.on_evict(*this, it);
+		weight -= weigher(it->first, it->second);
 		map.remove(it);
-		map.insert(sjtu::pair(v, value));
-		return &(map.find(v)->second);
+	}
+    /**
+     * drop key if it is there, return whether it was
+    */
+    bool remove(const Key &key) {
+		iterator it = map.find(key);
+		if(it == map.end())
+			return false;
+		remove(it);
+		return true;
+	}
+    /**
+     * the counters so far (see stats.hpp)
+    */
+    cache_stats stats() const {
+		return counters.snapshot(map.expansions());
+	}
+    /**
+     * drop everything
+    */
+    void clear() {
+		uint64_t start = latency.start();
+		map.clear();
+		weight = 0;
+		policy.on_clear(*this);
+		latency.clear(start);
+	}
+    /**
+     * out[i] = get(keys[i]) for n keys at once.
+     * all hashes of a batch are computed first, then the lookups are
+     * pipelined: while key i is looked up and touched, the order
+     * neighbours of the node key i + prefetch_distance hashes to
+     * first (no key is compared before the lookup), the node of key
+     * i + 2 * prefetch_distance and the bucket of key
+     * i + 3 * prefetch_distance are on their way into the cache, so
+     * the misses of several keys overlap instead of adding up.
+     * hits are marked used in the order of keys.
+    */
+    void multi_get(const Key *keys, size_t n, T **out) {
+		pipelined(n, [keys](size_t i) -> const Key & { return keys[i]; },
+			[this, keys, out](size_t i, size_t hash_value){
+				auto it = map.find(keys[i], hash_value);
+				if(it == map.end()) {
+					counters.miss();
+					policy.on_miss(*this, keys[i]);
+					out[i] = nullptr;
+					return;
+				}
+				counters.hit();
+				policy.on_hit(*this, it);
+				out[i] = &(it->second);
+			});
+	}
+    /**
+     * save(values[i]) for i = 0 .. n - 1, pipelined like multi_get
+    */
+    void multi_save(const value_type *values, size_t n) {
+		pipelined(n, [values](size_t i) -> const Key & { return values[i].first; },
+			[this, values](size_t i, size_t hash_value){
+				store(values[i].first, values[i].second, hash_value);
+			});
 	}
     /**
      * just print everything in the memory
@@ -759,9 +1748,105 @@ public:
     */
     void print() const{
 		for (auto it = map.begin(); it != map.end(); it++) 
-        	std::cout << it->first.val << " " << it->second << std::endl;
+        	std::cout << printable(it->first) << " " << it->second << std::endl;
     }
+private:
+	/**
+	 * place key and obj, timed as an insert, an update or an expand
+	 * (an insert that grew the index) when SJTU_LATENCY is defined
+	 */
+	template<class M>
+	void store(const Key &key, M &&obj, size_t hash_value) {
+		uint64_t start = latency.start();
+		size_t expansions = map.expansions();
+		bool update = place(key, std::forward<M>(obj), hash_value);
+		latency.save(start, update, map.expansions() != expansions);
+	}
+	/**
+	 * an existing key takes the new value and counts as a hit, and
+	 * if it got heavier the policy's victims go until the weights
+	 * fit in c again, the updated element too if the policy picks
+	 * it while others are left; one heavier than c stays, alone.
+	 * the weight is only changed once the new value is in, so an
+	 * assignment that throws leaves it right.
+	 * a new key evicts the policy's victims until it fits, the last
+	 * one's node is taken over; one heavier than c still goes in,
+	 * alone.
+	 * return whether key was there
+	 */
+	template<class M>
+	bool place(const Key &key, M &&obj, size_t hash_value) {
+		iterator it = map.find(key, hash_value);
+		counters.save(it != map.end());
+		if(it != map.end()) {
+			size_t w = weigher(key, static_cast<const T &>(obj));
+			size_t old_weight = weigher(it->first, it->second);
+			it->second = std::forward<M>(obj);
+			weight = weight - old_weight + w;
+			policy.on_hit(*this, it);
+			bool resident = true;
+			while(weight > c && !map.empty()) {
+				iterator victim = policy.choose_victim(*this, key);
+				if(resident && victim == it) {
+					if(map.size() == 1)
+						break;
+					resident = false;
+				}
+				counters.evict(victim->first, victim->second);
+				remove(victim);
+			}
+			return true;
+		}
+		size_t w = weigher(key, static_cast<const T &>(obj));
+		while(weight + w > c && !map.empty()) {
+			iterator victim = policy.choose_victim(*this, key);
+			size_t victim_weight = weigher(victim->first, victim->second);
+			counters.evict(victim->first, victim->second);
+			if(weight - victim_weight + w > c && map.size() > 1) {
+				remove(victim);
+				continue;
+			}
+			policy.on_evict(*this, victim);
+			weight = weight - victim_weight + w;
+			it = map.replace(victim, key, std::forward<M>(obj), hash_value);
+			policy.on_insert(*this, it);
+			return false;
+		}
+		weight += w;
+		it = map.insert_new(key, std::forward<M>(obj), hash_value);
+		policy.on_insert(*this, it);
+		return false;
+	}
+	static const size_t batch = 64;
+	static const size_t prefetch_distance = 4;
+	/**
+	 * run resolve(i, hash of key i) for i = 0 .. n - 1 in order,
+	 * with the prefetches of the keys ahead interleaved
+	 */
+	template<class KeyAt, class Resolve>
+	void pipelined(size_t n, KeyAt key_at, Resolve resolve) {
+		size_t hashes[batch];
+		for(size_t first = 0; first < n; first += batch) {
+			size_t m = n - first < batch ? n - first : batch;
+			for(size_t i = 0; i < m; i++)
+				hashes[i] = map.hash(key_at(first + i));
+			for(size_t i = 0; i < m + 3 * prefetch_distance; i++) {
+				if(i < m)
+					map.prefetch_bucket(hashes[i]);
+				if(i >= prefetch_distance && i - prefetch_distance < m)
+					map.prefetch_node(hashes[i - prefetch_distance]);
+				size_t j = i - 2 * prefetch_distance;
+				if(i >= 2 * prefetch_distance && j < m)
+					map.prefetch_order(hashes[j]);
+				if(i >= 3 * prefetch_distance)
+					resolve(first + i - 3 * prefetch_distance, hashes[i - 3 * prefetch_distance]);
+			}
+		}
+	}
 };
+
+typedef basic_lru<Integer, Matrix<int>, Hash, Equal> lru;
+typedef basic_lru<Integer, Matrix<int>, Hash, Equal, chained_table, lru_policy, byte_weigher> byte_lru;
 }
 
 #endif
\ No newline at end of file
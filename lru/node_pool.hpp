@@ -0,0 +1,83 @@
+#ifndef SJTU_NODE_POOL_HPP
+#define SJTU_NODE_POOL_HPP
+
+#include <cstddef>
+#include <new>
+
+namespace sjtu {
+
+/**
+ * a slab allocator for fixed-size list nodes.
+ * nodes are carved out of slabs of about 4KB, and freed nodes are
+ * kept on an intrusive free list and handed out again before a new
+ * slab is taken, so a container whose size stays stable (e.g. a full
+ * lru) does no allocator call at all.
+ * one pool may be shared by several containers holding the same
+ * kind of node (e.g. every bucket of a hashmap).
+ */
+template<class Node>
+class node_pool{
+	union slot{
+		slot *next_free;
+		alignas(Node) unsigned char storage[sizeof(Node)];
+	};
+	static const size_t slab_bytes = 4096;
+	static const size_t slab_nodes = sizeof(slot) >= slab_bytes ? 1 : slab_bytes / sizeof(slot);
+	struct slab{
+		slab *next;
+		slot slots[slab_nodes];
+	};
+	slab *slabs;
+	slot *free_list;
+	size_t carved; // slots handed out from the newest slab
+public:
+	node_pool():slabs(nullptr), free_list(nullptr), carved(0){}
+	node_pool(const node_pool &) = delete;
+	node_pool & operator=(const node_pool &) = delete;
+	~node_pool(){
+		release();
+	}
+	/**
+	 * return raw storage for one Node,
+	 * the caller constructs it with placement new
+	 */
+	Node *allocate(){
+		if(free_list) {
+			slot *tmp = free_list;
+			free_list = tmp->next_free;
+			return reinterpret_cast<Node *>(tmp);
+		}
+		if(!slabs || carved == slab_nodes) {
+			slab *new_slab = static_cast<slab *>(::operator new(sizeof(slab)));
+			new_slab->next = slabs;
+			slabs = new_slab;
+			carved = 0;
+		}
+		return reinterpret_cast<Node *>(&slabs->slots[carved++]);
+	}
+	/**
+	 * give back the storage of a node which is already destroyed
+	 */
+	void deallocate(Node *p){
+		slot *tmp = reinterpret_cast<slot *>(p);
+		tmp->next_free = free_list;
+		free_list = tmp;
+	}
+	/**
+	 * free every slab at once.
+	 * all nodes must have been destroyed before.
+	 */
+	void release(){
+		while(slabs) {
+			slab *tmp = slabs;
+			slabs = slabs->next;
+			::operator delete(tmp);
+		}
+		free_list = nullptr;
+		carved = 0;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,1065 @@
+#ifndef SJTU_POLICY_HPP
+#define SJTU_POLICY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include "frequency_sketch.hpp"
+
+namespace sjtu {
+
+/**
+ * eviction policies of basic_lru.
+ * a policy is a class with
+ *   meta: what it keeps in every node of the linked_hashmap,
+ *   hooks<Map>: its state plus the hooks basic_lru calls, where
+ *     iterator is Map::iterator and cache the basic_lru, whose
+ *     map, c (the capacity), weigher and map.meta(it) the hooks
+ *     may use:
+ *       on_insert(cache, it)       a new element, at the end of the order
+ *       on_hit(cache, it)          get found it, or save updated it
+ *       on_miss(cache, key)        get didn't find key
+ *       choose_victim(cache, key)  the element to drop: the cache is
+ *                                  full and key is about to come in
+ *                                  (or was just updated and grew)
+ *       on_evict(cache, it)        it is about to be dropped
+ *       on_clear(cache)            everything was dropped
+ *     with weights, choose_victim and on_evict may come several
+ *     times in a row, and not always before an on_insert.
+ * the order list of the map is the policy's to arrange: a policy
+ * with several queues keeps them as consecutive runs of the one list
+ * (map.move_before moves a node in O(1)), so no hook allocates
+ * (except where a policy keeps more than the resident elements).
+ * a policy may also say shared_hits = true: its on_hit only does
+ * relaxed atomic stores, so hits may run in several threads at once
+ * under a shared lock (see buffered_lru); hashed_misses = true: its
+ * on_miss only needs the hash of key (map.hash(key)), and it has an
+ *       on_miss_hashed(cache, hash_value)
+ * that does the same from the hash alone, so misses can be recorded
+ * by readers and replayed later (see buffered_lru); and
+ * elements_only = true: it sizes its queues by c as a number of
+ * elements, so it can't be used with a weigher other than
+ * unit_weigher.
+ */
+
+/**
+ * whether Policy says shared_hits = true
+ */
+template<class Policy, class = void>
+struct has_shared_hits :std::false_type {};
+template<class Policy>
+struct has_shared_hits<Policy, decltype(void(Policy::shared_hits))>
+	:std::integral_constant<bool, Policy::shared_hits> {};
+/**
+ * whether Policy says hashed_misses = true
+ */
+template<class Policy, class = void>
+struct has_hashed_misses :std::false_type {};
+template<class Policy>
+struct has_hashed_misses<Policy, decltype(void(Policy::hashed_misses))>
+	:std::integral_constant<bool, Policy::hashed_misses> {};
+/**
+ * whether Policy says elements_only = true
+ */
+template<class Policy, class = void>
+struct is_elements_only :std::false_type {};
+template<class Policy>
+struct is_elements_only<Policy, decltype(void(Policy::elements_only))>
+	:std::integral_constant<bool, Policy::elements_only> {};
+
+/**
+ * nothing kept per node, a Node deriving from it grows by 0 bytes
+ */
+struct no_meta {};
+
+/**
+ * least recently used: a hit moves the element to the end,
+ * the first one goes. the default, with no state at all.
+ */
+struct lru_policy{
+	typedef no_meta meta;
+	template<class Map>
+	struct hooks{
+		typedef typename Map::iterator iterator;
+		template<class Cache>
+		void on_insert(Cache &, iterator) {}
+		template<class Cache>
+		void on_hit(Cache &cache, iterator it) {
+			cache.map.touch(it);
+		}
+		template<class Cache, class Key>
+		void on_miss(Cache &, const Key &) {}
+		template<class Cache, class Key>
+		iterator choose_victim(Cache &cache, const Key &) {
+			return cache.map.begin();
+		}
+		template<class Cache>
+		void on_evict(Cache &, iterator) {}
+		template<class Cache>
+		void on_clear(Cache &) {}
+	};
+};
+
+/**
+ * first in, first out: hits change nothing
+ */
+struct fifo_policy{
+	typedef no_meta meta;
+	template<class Map>
+	struct hooks{
+		typedef typename Map::iterator iterator;
+		template<class Cache>
+		void on_insert(Cache &, iterator) {}
+		template<class Cache>
+		void on_hit(Cache &, iterator) {}
+		template<class Cache, class Key>
+		void on_miss(Cache &, const Key &) {}
+		template<class Cache, class Key>
+		iterator choose_victim(Cache &cache, const Key &) {
+			return cache.map.begin();
+		}
+		template<class Cache>
+		void on_evict(Cache &, iterator) {}
+		template<class Cache>
+		void on_clear(Cache &) {}
+	};
+};
+
+/**
+ * a uniformly random victim: every element has a slot in a vector
+ * of iterators, and a node remembers its slot so that removing it
+ * moves the last slot into the hole
+ */
+struct random_policy{
+	struct meta{
+		size_t slot;
+	};
+	template<class Map>
+	class hooks{
+		typedef typename Map::iterator iterator;
+		std::vector<iterator> elements;
+		unsigned long long state;
+	public:
+		hooks():state(0x9e3779b97f4a7c15ull){}
+		hooks(const hooks &) = delete;
+		hooks & operator=(const hooks &) = delete;
+		template<class Cache>
+		void on_insert(Cache &cache, iterator it) {
+			cache.map.meta(it).slot = elements.size();
+			elements.push_back(it);
+		}
+		template<class Cache>
+		void on_hit(Cache &, iterator) {}
+		template<class Cache, class Key>
+		void on_miss(Cache &, const Key &) {}
+		template<class Cache, class Key>
+		iterator choose_victim(Cache &, const Key &) {
+			// xorshift64*
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+			return elements[(state * 2685821657736338717ull >> 32) % elements.size()];
+		}
+		template<class Cache>
+		void on_evict(Cache &cache, iterator it) {
+			size_t slot = cache.map.meta(it).slot;
+			elements[slot] = elements.back();
+			cache.map.meta(elements[slot]).slot = slot;
+			elements.pop_back();
+		}
+		template<class Cache>
+		void on_clear(Cache &) {
+			elements.clear();
+		}
+	};
+};
+
+/**
+ * segmented lru: a new element is on probation, a hit promotes it to
+ * the protected segment, which holds at most 80% of the capacity and
+ * demotes its least recently used element back to probation when it
+ * overflows. victims come from probation first, so one pass over
+ * many keys can't flush what was used twice.
+ * the order list is [probation ... | protected ...], boundary is the
+ * first protected node (end() when there is none): inserting goes
+ * right before it and demoting just moves it one node on.
+ */
+struct slru_policy{
+	static const bool elements_only = true;
+	struct meta{
+		bool is_protected;
+	};
+	template<class Map>
+	class hooks{
+		typedef typename Map::iterator iterator;
+		iterator boundary;
+		size_t protected_count;
+	public:
+		hooks():boundary(), protected_count(0){}
+		hooks(const hooks &) = delete;
+		hooks & operator=(const hooks &) = delete;
+		template<class Cache>
+		void on_insert(Cache &cache, iterator it) {
+			cache.map.meta(it).is_protected = false;
+			if(boundary != cache.map.end())
+				cache.map.move_before(it, boundary);
+		}
+		template<class Cache>
+		void on_hit(Cache &cache, iterator it) {
+			iterator next = it;
+			++next;
+			if(cache.map.meta(it).is_protected) {
+				if(next == cache.map.end())
+					return;
+				if(it == boundary)
+					boundary = next;
+				cache.map.touch(it);
+				return;
+			}
+			cache.map.meta(it).is_protected = true;
+			protected_count++;
+			cache.map.touch(it);
+			if(boundary == cache.map.end())
+				boundary = it;
+			if(protected_count > cache.c - cache.c / 5) {
+				// the first protected node is right after the last
+				// probation one: demoting it moves nothing
+				cache.map.meta(boundary).is_protected = false;
+				protected_count--;
+				++boundary;
+			}
+		}
+		template<class Cache, class Key>
+		void on_miss(Cache &, const Key &) {}
+		template<class Cache, class Key>
+		iterator choose_victim(Cache &cache, const Key &) {
+			return cache.map.begin();
+		}
+		template<class Cache>
+		void on_evict(Cache &cache, iterator it) {
+			if(it == boundary)
+				++boundary;
+			if(cache.map.meta(it).is_protected)
+				protected_count--;
+		}
+		template<class Cache>
+		void on_clear(Cache &cache) {
+			boundary = cache.map.end();
+			protected_count = 0;
+		}
+	};
+};
+
+/**
+ * W-TinyLFU (Einziger, Friedman and Manes): a new element goes to a
+ * small window lru of 1% of the capacity, the rest is a segmented
+ * lru (the main part, 80% of it protected). when the window is full
+ * its least recently used element is a candidate for main and only
+ * gets in if the frequency_sketch says it was seen more often than
+ * main's victim, otherwise the candidate itself goes. so keys seen
+ * once, like a scan, churn through the window and leave main alone.
+ * every get, hit or miss, and every save counts as an access.
+ * the order list is [probation ... | protected ... | window ...],
+ * with protected_first and window_first the first node of the last
+ * two runs (end() for an empty run).
+ */
+struct tinylfu_policy{
+	static const bool hashed_misses = true;
+	static const bool elements_only = true;
+	struct meta{
+		unsigned char segment;
+	};
+	template<class Map>
+	class hooks{
+		typedef typename Map::iterator iterator;
+		enum { probation, protected_segment, window };
+		iterator protected_first, window_first;
+		size_t protected_count, window_count;
+		frequency_sketch sketch;
+	public:
+		hooks():protected_first(), window_first(), protected_count(0), window_count(0){}
+		hooks(const hooks &) = delete;
+		hooks & operator=(const hooks &) = delete;
+		template<class Cache>
+		void on_insert(Cache &cache, iterator it) {
+			sketch.ensure_capacity(cache.c);
+			sketch.increment(cache.map.hash(it->first));
+			cache.map.meta(it).segment = window;
+			if(!window_count++)
+				window_first = it;
+			// not full yet: what leaves the window goes to main freely
+			if(window_count > window_capacity(cache.c))
+				admit(cache);
+		}
+		template<class Cache>
+		void on_hit(Cache &cache, iterator it) {
+			sketch.increment(cache.map.hash(it->first));
+			unsigned char &segment = cache.map.meta(it).segment;
+			if(segment == window) {
+				if(it == window_first && window_count > 1)
+					++window_first;
+				cache.map.touch(it);
+				return;
+			}
+			if(segment == protected_segment) {
+				if(it == protected_first && protected_count > 1)
+					++protected_first;
+				cache.map.move_before(it, window_first);
+				return;
+			}
+			segment = protected_segment;
+			cache.map.move_before(it, window_first);
+			if(!protected_count++)
+				protected_first = it;
+			size_t main = cache.c - window_capacity(cache.c);
+			if(protected_count > main - main / 5) {
+				// right after the last probation node already
+				cache.map.meta(protected_first).segment = probation;
+				if(--protected_count)
+					++protected_first;
+				else
+					protected_first = cache.map.end();
+			}
+		}
+		template<class Cache, class Key>
+		void on_miss(Cache &cache, const Key &key) {
+			on_miss_hashed(cache, cache.map.hash(key));
+		}
+		template<class Cache>
+		void on_miss_hashed(Cache &cache, size_t hash_value) {
+			sketch.ensure_capacity(cache.c);
+			sketch.increment(hash_value);
+		}
+		template<class Cache, class Key>
+		iterator choose_victim(Cache &cache, const Key &) {
+			iterator first = cache.map.begin();
+			if(window_count < window_capacity(cache.c) || first == window_first)
+				return first;
+			if(sketch.frequency(cache.map.hash(window_first->first)) <= sketch.frequency(cache.map.hash(first->first)))
+				return window_first;
+			admit(cache);
+			return first;
+		}
+		template<class Cache>
+		void on_evict(Cache &cache, iterator it) {
+			unsigned char segment = cache.map.meta(it).segment;
+			if(segment == window && it == window_first)
+				window_first = --window_count ? ++it : cache.map.end();
+			else if(segment == window)
+				window_count--;
+			else if(segment == protected_segment && it == protected_first)
+				protected_first = --protected_count ? ++it : cache.map.end();
+			else if(segment == protected_segment)
+				protected_count--;
+		}
+		template<class Cache>
+		void on_clear(Cache &cache) {
+			protected_first = window_first = cache.map.end();
+			protected_count = window_count = 0;
+			sketch.clear();
+		}
+	private:
+		/**
+		 * the first window node becomes the newest probation node
+		 */
+		template<class Cache>
+		void admit(Cache &cache) {
+			iterator candidate = window_first;
+			if(--window_count)
+				++window_first;
+			else
+				window_first = cache.map.end();
+			cache.map.meta(candidate).segment = probation;
+			cache.map.move_before(candidate, protected_count ? protected_first : window_first);
+		}
+		static size_t window_capacity(size_t c) {
+			return c / 100 ? c / 100 : 1;
+		}
+	};
+};
+
+/**
+ * ARC (Megiddo and Modha): T1 holds what was used once lately, T2
+ * what was used at least twice, and the ghost lists B1 / B2 only
+ * the keys recently evicted from T1 / T2. a miss on a ghost key
+ * means its list was too short: a B1 hit moves the target size p of
+ * T1 up, a B2 hit moves it down, and the key comes back into T2.
+ * the victim is T1's oldest while T1 is over p, T2's oldest otherwise.
+ * T1 and T2 are the runs [T1 ... | T2 ...] of the order list (t2_first
+ * the first T2 node); the ghosts are key-only nodes of a second map
+ * of the same kind, [B1 ... | B2 ...], and there are at most c of
+ * them. every step is O(1).
+ */
+struct arc_policy{
+	static const bool elements_only = true;
+	struct meta{
+		bool in_t2;
+	};
+	template<class Map>
+	class hooks{
+		typedef typename Map::iterator iterator;
+		typedef typename Map::template rebind<bool> ghost_map; // key -> in B2
+		typedef typename ghost_map::iterator ghost_iterator;
+		iterator t2_first;
+		size_t t1_count, t2_count;
+		ghost_map ghosts;
+		ghost_iterator b2_first;
+		size_t b1_count, b2_count;
+		size_t p; // target size of T1
+		bool to_t2; // the key being saved was a ghost
+		bool to_ghost; // the victim chosen is remembered in a ghost list
+	public:
+		hooks():t2_first(), t1_count(0), t2_count(0), b2_first(), b1_count(0), b2_count(0),
+			p(0), to_t2(false), to_ghost(false){}
+		hooks(const hooks &) = delete;
+		hooks & operator=(const hooks &) = delete;
+		template<class Cache>
+		void on_insert(Cache &cache, iterator it) {
+			// a ghost saved while the cache isn't full (after c grew, or
+			// with weights), choose_victim didn't see it
+			if(!to_t2 && b1_count + b2_count) {
+				ghost_iterator ghost = ghosts.find(it->first);
+				if(ghost != ghosts.end())
+					ghost_hit(cache.c, ghost);
+			}
+			if(!to_t2) {
+				cache.map.meta(it).in_t2 = false;
+				cache.map.move_before(it, t2_first);
+				t1_count++;
+				return;
+			}
+			to_t2 = false;
+			cache.map.meta(it).in_t2 = true;
+			if(!t2_count++)
+				t2_first = it;
+		}
+		template<class Cache>
+		void on_hit(Cache &cache, iterator it) {
+			if(cache.map.meta(it).in_t2) {
+				if(it == t2_first && t2_count > 1)
+					++t2_first;
+				cache.map.touch(it);
+				return;
+			}
+			cache.map.meta(it).in_t2 = true;
+			t1_count--;
+			cache.map.touch(it);
+			if(!t2_count++)
+				t2_first = it;
+		}
+		template<class Cache, class Key>
+		void on_miss(Cache &, const Key &) {}
+		template<class Cache, class Key>
+		iterator choose_victim(Cache &cache, const Key &key) {
+			size_t c = cache.c;
+			if(!c) {
+				to_ghost = false;
+				return cache.map.begin();
+			}
+			ghost_iterator ghost = ghosts.find(key);
+			bool in_b2 = false;
+			if(ghost != ghosts.end())
+				in_b2 = ghost_hit(c, ghost);
+			else if(t1_count + b1_count >= c) {
+				if(!b1_count && t1_count) {
+					// T1 fills the cache: its oldest goes for good
+					to_ghost = false;
+					return cache.map.begin();
+				}
+				if(b1_count)
+					drop_ghost(ghosts.begin());
+			}else if(t1_count + t2_count + b1_count + b2_count >= 2 * c && b2_count)
+				drop_ghost(b2_first);
+			to_ghost = true;
+			if(t1_count && (t1_count > p || (in_b2 && t1_count == p) || !t2_count))
+				return cache.map.begin();
+			return t2_first;
+		}
+		template<class Cache>
+		void on_evict(Cache &cache, iterator it) {
+			bool in_t2 = cache.map.meta(it).in_t2;
+			if(in_t2 && it == t2_first) {
+				iterator next = it;
+				t2_first = --t2_count ? ++next : cache.map.end();
+			}else if(in_t2)
+				t2_count--;
+			else
+				t1_count--;
+			if(!to_ghost)
+				return;
+			to_ghost = false;
+			ghost_iterator ghost = ghosts.insert_or_assign(it->first, in_t2).first;
+			if(in_t2) {
+				if(!b2_count++)
+					b2_first = ghost;
+			}else {
+				ghosts.move_before(ghost, b2_first);
+				b1_count++;
+			}
+		}
+		template<class Cache>
+		void on_clear(Cache &cache) {
+			t2_first = cache.map.end();
+			t1_count = t2_count = 0;
+			ghosts.clear();
+			b2_first = ghosts.end();
+			b1_count = b2_count = 0;
+			p = 0;
+			to_t2 = to_ghost = false;
+		}
+	private:
+		/**
+		 * key was in a ghost list: adapt p, forget the ghost and put
+		 * the key in T2; return whether it was in B2
+		 */
+		bool ghost_hit(size_t c, ghost_iterator ghost) {
+			bool in_b2 = ghost->second;
+			if(in_b2)
+				p -= step(b1_count, b2_count) < p ? step(b1_count, b2_count) : p;
+			else
+				p += step(b2_count, b1_count) < c - p ? step(b2_count, b1_count) : c - p;
+			drop_ghost(ghost);
+			to_t2 = true;
+			return in_b2;
+		}
+		/**
+		 * how far a ghost hit moves p: 1, or the ratio of the other
+		 * ghost list to the one hit if that is more
+		 */
+		static size_t step(size_t other, size_t hit) {
+			return other > hit ? other / hit : 1;
+		}
+		void drop_ghost(ghost_iterator ghost) {
+			if(ghost->second) {
+				if(ghost == b2_first) {
+					ghost_iterator next = ghost;
+					b2_first = --b2_count ? ++next : ghosts.end();
+				}else
+					b2_count--;
+			}else
+				b1_count--;
+			ghosts.remove(ghost);
+		}
+	};
+};
+
+
+/**
+ * a slot of the clock policies: an element and its reference bit.
+ * a hit sets the bit only if it is clear, so hits on a hot element
+ * read the line and don't write it.
+ */
+template<class Iterator>
+struct clock_slot{
+	static const unsigned char vacant = 255; // its element was evicted
+	Iterator it;
+	std::atomic<bool> referenced;
+	unsigned char status; // vacant, or clock_pro_policy's hot / cold / cold in test
+	clock_slot(Iterator it):it(it), referenced(false), status(0){}
+	clock_slot(const clock_slot &other)
+		:it(other.it), referenced(other.referenced.load(std::memory_order_relaxed)), status(other.status){}
+	clock_slot & operator=(const clock_slot &) = delete;
+	void reference() {
+		if(!referenced.load(std::memory_order_relaxed))
+			referenced.store(true, std::memory_order_relaxed);
+	}
+	/**
+	 * clear the bit, return whether it was set
+	 */
+	bool clear_reference() {
+		if(!referenced.load(std::memory_order_relaxed))
+			return false;
+		referenced.store(false, std::memory_order_relaxed);
+		return true;
+	}
+};
+
+/**
+ * the slots of a clock policy. an evicted element leaves its slot
+ * vacant and the next new element takes the latest vacant slot, so
+ * it lands right behind the hand that evicted.
+ */
+template<class Iterator>
+class clock_slots{
+	std::vector<clock_slot<Iterator>> slots;
+	std::vector<size_t> vacant;
+public:
+	size_t size() const {
+		return slots.size();
+	}
+	/**
+	 * the slots that are not vacant
+	 */
+	size_t live() const {
+		return slots.size() - vacant.size();
+	}
+	clock_slot<Iterator> &operator[](size_t i) {
+		return slots[i];
+	}
+	/**
+	 * a slot for it, unreferenced with status 0
+	 */
+	size_t place(Iterator it) {
+		if(vacant.empty()) {
+			slots.push_back(clock_slot<Iterator>(it));
+			return slots.size() - 1;
+		}
+		size_t i = vacant.back();
+		vacant.pop_back();
+		slots[i].it = it;
+		slots[i].referenced.store(false, std::memory_order_relaxed);
+		slots[i].status = 0;
+		return i;
+	}
+	void vacate(size_t i) {
+		slots[i].status = clock_slot<Iterator>::vacant;
+		vacant.push_back(i);
+	}
+	void clear() {
+		slots.clear();
+		vacant.clear();
+	}
+};
+
+/**
+ * CLOCK, lru by second chance: every element has a slot in a vector
+ * swept by a hand, and a hit only sets the slot's reference bit, no
+ * node is relinked. the hand clears the set bits it passes and takes
+ * the first element whose bit is clear; the new element gets the
+ * victim's slot, right behind the hand (see clock_slots).
+ * hits are shared (see has_shared_hits).
+ */
+struct clock_policy{
+	static const bool shared_hits = true;
+	struct meta{
+		size_t slot;
+	};
+	template<class Map>
+	class hooks{
+		typedef typename Map::iterator iterator;
+		clock_slots<iterator> slots;
+		size_t hand;
+	public:
+		hooks():hand(0){}
+		hooks(const hooks &) = delete;
+		hooks & operator=(const hooks &) = delete;
+		template<class Cache>
+		void on_insert(Cache &cache, iterator it) {
+			cache.map.meta(it).slot = slots.place(it);
+		}
+		template<class Cache>
+		void on_hit(Cache &cache, iterator it) {
+			slots[cache.map.meta(it).slot].reference();
+		}
+		template<class Cache, class Key>
+		void on_miss(Cache &, const Key &) {}
+		template<class Cache, class Key>
+		iterator choose_victim(Cache &, const Key &) {
+			while(true) {
+				if(hand >= slots.size())
+					hand = 0;
+				clock_slot<iterator> &s = slots[hand];
+				if(s.status != s.vacant && !s.clear_reference())
+					return s.it;
+				hand++;
+			}
+		}
+		template<class Cache>
+		void on_evict(Cache &cache, iterator it) {
+			size_t slot = cache.map.meta(it).slot;
+			slots.vacate(slot);
+			if(hand == slot)
+				hand++;
+		}
+		template<class Cache>
+		void on_clear(Cache &) {
+			slots.clear();
+			hand = 0;
+		}
+	};
+};
+
+/**
+ * CLOCK-Pro (Jiang, Chen and Zhang), on the same slots as clock_policy.
+ * a resident element is hot or cold, and a new cold one is in its
+ * test period: if it is used again before the cold hand comes back
+ * to it, it turns hot. a cold element evicted while in test leaves
+ * its key behind as a non-resident test entry, and a key saved again
+ * while it has one comes back hot.
+ * the hot hand keeps at most c - cold_target elements hot: it clears
+ * the bits of hot elements and makes the first unreferenced one cold,
+ * and ends the test of the cold ones it passes.
+ * cold_target adapts like ARC's p: a reuse within a test period
+ * means cold elements need longer to prove themselves, +1; a test
+ * period that ran out, -1. it never goes below a tenth of c.
+ * the test entries are key-only nodes of a second map of the same
+ * kind, oldest first, at most c of them.
+ * hits are shared (see has_shared_hits).
+ */
+struct clock_pro_policy{
+	static const bool shared_hits = true;
+	static const bool elements_only = true;
+	struct meta{
+		size_t slot;
+	};
+	template<class Map>
+	class hooks{
+		typedef typename Map::iterator iterator;
+		typedef typename Map::template rebind<bool> test_map;
+		enum { cold, cold_in_test, hot };
+		clock_slots<iterator> slots;
+		test_map tests;
+		size_t hand_cold, hand_hot;
+		size_t hot_count;
+		size_t cold_target;
+	public:
+		hooks():hand_cold(0), hand_hot(0), hot_count(0), cold_target(0){}
+		hooks(const hooks &) = delete;
+		hooks & operator=(const hooks &) = delete;
+		template<class Cache>
+		void on_insert(Cache &cache, iterator it) {
+			size_t slot = slots.place(it);
+			cache.map.meta(it).slot = slot;
+			slots[slot].status = cold_in_test;
+			if(tests.empty())
+				return;
+			typename test_map::iterator test = tests.find(it->first);
+			if(test == tests.end())
+				return;
+			tests.remove(test);
+			slots[slot].status = hot;
+			hot_count++;
+			grow_cold(cache.c);
+			while(hot_count > hot_capacity(cache.c))
+				run_hot_hand(cache.c);
+		}
+		template<class Cache>
+		void on_hit(Cache &cache, iterator it) {
+			slots[cache.map.meta(it).slot].reference();
+		}
+		template<class Cache, class Key>
+		void on_miss(Cache &, const Key &) {}
+		template<class Cache, class Key>
+		iterator choose_victim(Cache &cache, const Key &) {
+			// only after c shrank can every element be hot
+			if(hot_count == slots.live())
+				run_hot_hand(cache.c);
+			while(true) {
+				if(hand_cold >= slots.size())
+					hand_cold = 0;
+				clock_slot<iterator> &s = slots[hand_cold];
+				if(s.status != hot && s.status != s.vacant) {
+					if(!s.clear_reference())
+						return s.it;
+					if(s.status == cold) {
+						s.status = cold_in_test;
+					}else {
+						s.status = hot;
+						hot_count++;
+						grow_cold(cache.c);
+						while(hot_count > hot_capacity(cache.c))
+							run_hot_hand(cache.c);
+					}
+				}
+				hand_cold++;
+			}
+		}
+		template<class Cache>
+		void on_evict(Cache &cache, iterator it) {
+			size_t slot = cache.map.meta(it).slot;
+			unsigned char status = slots[slot].status;
+			slots.vacate(slot);
+			if(hand_cold == slot)
+				hand_cold++;
+			if(status == hot)
+				hot_count--;
+			if(status != cold_in_test)
+				return;
+			tests.insert_or_assign(it->first, true);
+			if(tests.size() > cache.c) {
+				tests.remove(tests.begin());
+				shrink_cold(cache.c);
+			}
+		}
+		template<class Cache>
+		void on_clear(Cache &) {
+			slots.clear();
+			tests.clear();
+			hand_cold = hand_hot = 0;
+			hot_count = 0;
+			cold_target = 0;
+		}
+	private:
+		/**
+		 * a tenth of the cache stays cold at least, which bounds the
+		 * walk of the cold hand over hot slots to ~10 per eviction
+		 */
+		static size_t min_cold(size_t c) {
+			return c / 10 + 1;
+		}
+		size_t cold_capacity(size_t c) const {
+			return cold_target > min_cold(c) ? cold_target : min_cold(c);
+		}
+		size_t hot_capacity(size_t c) const {
+			return c > cold_capacity(c) ? c - cold_capacity(c) : 0;
+		}
+		void grow_cold(size_t c) {
+			cold_target = cold_capacity(c) < c ? cold_capacity(c) + 1 : c;
+		}
+		void shrink_cold(size_t c) {
+			if(cold_target > min_cold(c))
+				cold_target--;
+		}
+		/**
+		 * move the hot hand until it has made one hot element cold,
+		 * c is the capacity
+		 */
+		void run_hot_hand(size_t c) {
+			while(true) {
+				if(hand_hot >= slots.size())
+					hand_hot = 0;
+				clock_slot<iterator> &s = slots[hand_hot++];
+				if(s.status == hot && !s.clear_reference()) {
+					s.status = cold;
+					hot_count--;
+					return;
+				}
+				if(s.status == cold_in_test && !s.referenced.load(std::memory_order_relaxed)) {
+					s.status = cold;
+					shrink_cold(c);
+				}
+			}
+		}
+	};
+};
+
+
+/**
+ * S3-FIFO (Yang et al.): three FIFO queues, nothing is reordered on
+ * a hit, which only bumps the element's 2-bit counter.
+ * a new element goes to the small queue S, or straight to the main
+ * queue M when its key is in the ghost queue G. to make room, S is
+ * evicted from while it holds 10% of c or more, M otherwise:
+ * - S's oldest element moves on to M if it was used since it came
+ *   in, otherwise it goes and leaves its key in G;
+ * - M's oldest element goes if its counter is 0, otherwise it is
+ *   put back at M's end with the counter one lower.
+ * so one-hit wonders leave through S quickly while anything used
+ * twice stays in M for a while.
+ * the order list is [S ... | M ...] (m_first the first M node), both
+ * queues oldest first; G is key-only nodes of a second map of the
+ * same kind, oldest first, as long as M may be at most.
+ * hits are shared (see has_shared_hits).
+ */
+struct s3fifo_policy{
+	static const bool shared_hits = true;
+	static const bool elements_only = true;
+	struct meta{
+		std::atomic<unsigned char> frequency; // 0-3
+		bool in_main;
+	};
+	template<class Map>
+	class hooks{
+		typedef typename Map::iterator iterator;
+		typedef typename Map::template rebind<bool> ghost_map;
+		iterator m_first;
+		size_t s_count, m_count;
+		ghost_map ghosts;
+	public:
+		hooks():m_first(), s_count(0), m_count(0){}
+		hooks(const hooks &) = delete;
+		hooks & operator=(const hooks &) = delete;
+		template<class Cache>
+		void on_insert(Cache &cache, iterator it) {
+			cache.map.meta(it).frequency.store(0, std::memory_order_relaxed);
+			if(!ghosts.empty()) {
+				typename ghost_map::iterator ghost = ghosts.find(it->first);
+				if(ghost != ghosts.end()) {
+					ghosts.remove(ghost);
+					cache.map.meta(it).in_main = true;
+					if(!m_count++)
+						m_first = it;
+					return;
+				}
+			}
+			cache.map.meta(it).in_main = false;
+			s_count++;
+			cache.map.move_before(it, m_first);
+		}
+		template<class Cache>
+		void on_hit(Cache &cache, iterator it) {
+			std::atomic<unsigned char> &frequency = cache.map.meta(it).frequency;
+			unsigned char f = frequency.load(std::memory_order_relaxed);
+			if(f < 3)
+				frequency.store(f + 1, std::memory_order_relaxed);
+		}
+		template<class Cache, class Key>
+		void on_miss(Cache &, const Key &) {}
+		template<class Cache, class Key>
+		iterator choose_victim(Cache &cache, const Key &) {
+			while(true) {
+				if(s_count && (s_count >= small_capacity(cache.c) || !m_count)) {
+					iterator it = cache.map.begin();
+					if(!cache.map.meta(it).frequency.load(std::memory_order_relaxed))
+						return it;
+					// used again while in S: on to M's end
+					cache.map.meta(it).in_main = true;
+					cache.map.meta(it).frequency.store(0, std::memory_order_relaxed);
+					s_count--;
+					cache.map.touch(it);
+					if(!m_count++)
+						m_first = it;
+					continue;
+				}
+				iterator it = m_first;
+				unsigned char f = cache.map.meta(it).frequency.load(std::memory_order_relaxed);
+				if(!f)
+					return it;
+				cache.map.meta(it).frequency.store(f - 1, std::memory_order_relaxed);
+				if(m_count > 1) {
+					++m_first;
+					cache.map.touch(it);
+				}
+			}
+		}
+		template<class Cache>
+		void on_evict(Cache &cache, iterator it) {
+			if(cache.map.meta(it).in_main) {
+				if(it == m_first) {
+					iterator next = it;
+					m_first = --m_count ? ++next : cache.map.end();
+				}else
+					m_count--;
+				return;
+			}
+			s_count--;
+			ghosts.insert_or_assign(it->first, true);
+			if(ghosts.size() > cache.c - cache.c / 10)
+				ghosts.remove(ghosts.begin());
+		}
+		template<class Cache>
+		void on_clear(Cache &cache) {
+			m_first = cache.map.end();
+			s_count = m_count = 0;
+			ghosts.clear();
+		}
+	private:
+		static size_t small_capacity(size_t c) {
+			return c / 10 ? c / 10 : 1;
+		}
+	};
+};
+
+
+/**
+ * GreedyDual-Size-Frequency (Cherkasova): the element with the lowest
+ * priority L + frequency / weight goes, weight being the cache's
+ * weigher of it and L the priority of the last victim. so small
+ * elements used often stay and big ones used rarely go first, and as
+ * L rises what isn't used any more ages out.
+ * the priorities are a binary heap of iterators and a node remembers
+ * its place in it: O(log n) per insert, hit and eviction.
+ * meant for byte budgets (a byte_weigher); with unit weights it is
+ * an lfu with aging.
+ */
+struct gdsf_policy{
+	struct meta{
+		size_t slot;
+		size_t frequency;
+		double priority;
+	};
+	template<class Map>
+	class hooks{
+		typedef typename Map::iterator iterator;
+		std::vector<iterator> heap;
+		double inflation; // L
+	public:
+		hooks():inflation(0){}
+		hooks(const hooks &) = delete;
+		hooks & operator=(const hooks &) = delete;
+		template<class Cache>
+		void on_insert(Cache &cache, iterator it) {
+			cache.map.meta(it).frequency = 1;
+			cache.map.meta(it).priority = priority_of(cache, it);
+			cache.map.meta(it).slot = heap.size();
+			heap.push_back(it);
+			sift_up(cache, heap.size() - 1);
+		}
+		template<class Cache>
+		void on_hit(Cache &cache, iterator it) {
+			cache.map.meta(it).frequency++;
+			cache.map.meta(it).priority = priority_of(cache, it);
+			// an update may have made it heavier, and its priority lower
+			sift_down(cache, sift_up(cache, cache.map.meta(it).slot));
+		}
+		template<class Cache, class Key>
+		void on_miss(Cache &, const Key &) {}
+		template<class Cache, class Key>
+		iterator choose_victim(Cache &, const Key &) {
+			return heap[0];
+		}
+		template<class Cache>
+		void on_evict(Cache &cache, iterator it) {
+			inflation = cache.map.meta(it).priority;
+			size_t slot = cache.map.meta(it).slot;
+			heap[slot] = heap.back();
+			cache.map.meta(heap[slot]).slot = slot;
+			heap.pop_back();
+			if(slot < heap.size())
+				sift_down(cache, sift_up(cache, slot));
+		}
+		template<class Cache>
+		void on_clear(Cache &) {
+			heap.clear();
+			inflation = 0;
+		}
+	private:
+		template<class Cache>
+		double priority_of(Cache &cache, iterator it) const {
+			size_t weight = cache.weigher(it->first, it->second);
+			return inflation + double(cache.map.meta(it).frequency) / double(weight ? weight : 1);
+		}
+		template<class Cache>
+		bool lower(Cache &cache, size_t i, size_t j) const {
+			return cache.map.meta(heap[i]).priority < cache.map.meta(heap[j]).priority;
+		}
+		template<class Cache>
+		void swap_slots(Cache &cache, size_t i, size_t j) {
+			iterator tmp = heap[i];
+			heap[i] = heap[j];
+			heap[j] = tmp;
+			cache.map.meta(heap[i]).slot = i;
+			cache.map.meta(heap[j]).slot = j;
+		}
+		/**
+		 * return where slot i ended up
+		 */
+		template<class Cache>
+		size_t sift_up(Cache &cache, size_t i) {
+			while(i && lower(cache, i, (i - 1) / 2)) {
+				swap_slots(cache, i, (i - 1) / 2);
+				i = (i - 1) / 2;
+			}
+			return i;
+		}
+		template<class Cache>
+		void sift_down(Cache &cache, size_t i) {
+			while(true) {
+				size_t least = i, left = 2 * i + 1, right = 2 * i + 2;
+				if(left < heap.size() && lower(cache, left, least))
+					least = left;
+				if(right < heap.size() && lower(cache, right, least))
+					least = right;
+				if(least == i)
+					return;
+				swap_slots(cache, i, least);
+				i = least;
+			}
+		}
+	};
+};
+
+}
+
+#endif
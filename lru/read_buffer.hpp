@@ -0,0 +1,90 @@
+#ifndef SJTU_READ_BUFFER_HPP
+#define SJTU_READ_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include "hashing.hpp"
+
+namespace sjtu {
+
+/**
+ * striped, lossy ring buffers of accesses, after Caffeine's read
+ * buffers: readers record() an entry (e.g. the node of a hit) with
+ * one CAS on the ring of their stripe, and the owner of the
+ * structure later drain()s all rings at once and applies the
+ * accesses in a batch.
+ * a full ring drops the entry, losing a little recency information
+ * instead of blocking the reader.
+ * record may run concurrently from any number of threads, drain must
+ * not run concurrently with record or with itself (the caller keeps
+ * readers out with a lock while draining).
+ */
+template<class Entry, size_t Stripes = 16, size_t Size = 32>
+class read_buffer{
+	static_assert(std::is_trivially_copyable<Entry>::value, "entries are copied through std::atomic");
+	static_assert(!(Stripes & (Stripes - 1)) && !(Size & (Size - 1)), "Stripes and Size must be powers of two");
+	struct alignas(64) ring{
+		std::atomic<size_t> head; // next entry to drain
+		std::atomic<size_t> tail; // next free slot
+		std::atomic<Entry> slots[Size];
+		ring():head(0), tail(0){}
+	};
+	ring rings[Stripes];
+public:
+	static const size_t capacity = Stripes * Size;
+
+	read_buffer(){}
+	read_buffer(const read_buffer &) = delete;
+	read_buffer & operator=(const read_buffer &) = delete;
+
+	/**
+	 * return false if the ring of this thread was full and the
+	 * entry was dropped: time to drain
+	 */
+	bool record(Entry e){
+		ring &r = rings[stripe()];
+		size_t head = r.head.load(std::memory_order_relaxed);
+		size_t tail = r.tail.load(std::memory_order_relaxed);
+		while(true) {
+			if(tail - head >= Size)
+				return false;
+			if(r.tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+				break;
+		}
+		r.slots[tail & (Size - 1)].store(e, std::memory_order_relaxed);
+		return true;
+	}
+	/**
+	 * call f(entry) on every recorded entry, ring by ring in the
+	 * order they were recorded, and empty the rings
+	 */
+	template<class F>
+	void drain(F f){
+		for(size_t i = 0; i < Stripes; i++) {
+			ring &r = rings[i];
+			size_t tail = r.tail.load(std::memory_order_relaxed);
+			for(size_t j = r.head.load(std::memory_order_relaxed); j != tail; j++)
+				f(r.slots[j & (Size - 1)].load(std::memory_order_relaxed));
+			r.head.store(tail, std::memory_order_relaxed);
+		}
+	}
+	/**
+	 * forget every recorded entry
+	 */
+	void discard(){
+		for(size_t i = 0; i < Stripes; i++)
+			rings[i].head.store(rings[i].tail.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+private:
+	static size_t stripe(){
+		static thread_local size_t mine = mix_hashing::mix(std::hash<std::thread::id>()(std::this_thread::get_id()));
+		return mine & (Stripes - 1);
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef SJTU_ROBIN_HOOD_HPP
+#define SJTU_ROBIN_HOOD_HPP
+
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * table tag, see hashing.hpp for the default chained_table
+ * robin_hood_table: open addressing over one contiguous slot array
+ */
+struct robin_hood_table {};
+
+/**
+ * key extractors for the open addressing tables
+ */
+struct pair_key{
+	template<class P>
+	const auto &operator()(const P &p) const { return p.first; }
+};
+struct node_key{
+	template<class N>
+	const auto &operator()(const N *n) const { return n->data.first; }
+};
+
+/**
+ * an open addressing table with robin hood probing.
+ * dist[i] is 0 for an empty slot, otherwise 1 + the distance of
+ * slots[i] from its home slot. inserting steals the slot of any
+ * element closer to its home, so a lookup can stop as soon as it
+ * meets a smaller dist, and removing shifts the following run one
+ * slot back, so no tombstone is ever left.
+ * the capacity is a power of two and the home slot is taken from
+ * the high bits of hash * 2^64/phi.
+ */
+template<class Slot, class Key, class KeyOf, class Hash, class Equal>
+class robin_hood_core{
+public:
+	static const size_t npos = size_t(-1);
+	static const size_t initial_capacity = 16;
+	static const unsigned char max_dist = 255; // longest probe, grow past it
+
+	Slot *slots;
+	unsigned char *dist;
+	size_t capacity;
+	size_t shift; // 64 - log2(capacity)
+	size_t size; // record the number of elements
+	size_t expansions; // times the capacity grew
+	Hash hash_function;
+	Equal equal_function;
+	KeyOf key_of;
+	// --------------------------
+	robin_hood_core():slots(nullptr), dist(nullptr), capacity(0), shift(64), size(0), expansions(0){
+		allocate(initial_capacity);
+	}
+	robin_hood_core(const robin_hood_core &other)
+		:slots(nullptr), dist(nullptr), capacity(0), shift(64), size(0), expansions(0),
+		 hash_function(other.hash_function), equal_function(other.equal_function){
+		copy_from(other);
+	}
+	robin_hood_core & operator=(const robin_hood_core &other){
+		if(this != &other) {
+			clear();
+			deallocate();
+			hash_function = other.hash_function;
+			equal_function = other.equal_function;
+			copy_from(other);
+		}
+		return *this;
+	}
+	~robin_hood_core(){
+		clear();
+		deallocate();
+	}
+
+	size_t home(const Key &key) const {
+		return home_of(hash_function(key));
+	}
+	size_t home_of(size_t hash_value) const {
+		return (static_cast<unsigned long long>(hash_value) * 11400714819323198485ull) >> shift;
+	}
+	size_t next(size_t i) const {
+		return (i + 1) & (capacity - 1);
+	}
+	/**
+	 * the first slot on the probe sequence of key
+	 * which satisfies pred, npos if there is none
+	 */
+	template<class Pred>
+	size_t find_if(const Key &key, Pred pred) const {
+		return find_hashed(hash_function(key), pred);
+	}
+	/**
+	 * find_if and insert_new on a hash_function value computed
+	 * by the caller, so a lookup and the insert after it hash once
+	 */
+	template<class Pred>
+	size_t find_hashed(size_t hash_value, Pred pred) const {
+		size_t i = home_of(hash_value);
+		for(unsigned d = 1; d <= dist[i]; d++, i = next(i))
+			if(pred(slots[i]))
+				return i;
+		return npos;
+	}
+	/**
+	 * bring the first probe of hash_value into the cache
+	 */
+	void prefetch(size_t hash_value) const {
+		size_t i = home_of(hash_value);
+		__builtin_prefetch(dist + i);
+		__builtin_prefetch(slots + i);
+	}
+	/**
+	 * the slot holding key, npos if not found
+	 */
+	size_t find_index(const Key &key) const {
+		return find_if(key, [&](const Slot &slot){ return equal_function(key_of(slot), key); });
+	}
+	/**
+	 * insert an element whose key is not in the table yet,
+	 * return the slot it ends up in
+	 */
+	size_t insert_new(Slot &&value){
+		return insert_hashed(hash_function(key_of(value)), std::move(value));
+	}
+	size_t insert_hashed(size_t hash_value, Slot &&value){
+		if((size + 1) * 8 > capacity * 7)
+			rehash(capacity * 2);
+		size_t pos = npos;
+		alignas(Slot) unsigned char buffer[sizeof(Slot)];
+		Slot *carry = new (buffer) Slot(std::move(value));
+		size_t i = home_of(hash_value);
+		unsigned d = 1;
+		while(true) {
+			if(!dist[i]) {
+				new (&slots[i]) Slot(std::move(*carry));
+				carry->~Slot();
+				dist[i] = d;
+				size++;
+				return pos == npos ? i : pos;
+			}
+			if(dist[i] < d) {
+				// the resident is richer, take its slot and carry it on
+				Slot tmp(std::move(slots[i]));
+				slots[i].~Slot();
+				new (&slots[i]) Slot(std::move(*carry));
+				carry->~Slot();
+				new (carry) Slot(std::move(tmp));
+				unsigned tmp_d = dist[i];
+				dist[i] = d;
+				d = tmp_d;
+				if(pos == npos)
+					pos = i;
+			}
+			i = next(i);
+			if(++d > max_dist) {
+				// the probe got too long: grow, then place the carried one again
+				if(pos == npos) {
+					grow_or_drop(carry);
+					pos = insert_new(std::move(*carry));
+					carry->~Slot();
+					return pos;
+				}
+				Key key = key_of(slots[pos]);
+				grow_or_drop(carry);
+				insert_new(std::move(*carry));
+				carry->~Slot();
+				return find_index(key);
+			}
+		}
+	}
+	/**
+	 * remove the element in slot i and shift the run after it back
+	 */
+	void erase_at(size_t i){
+		slots[i].~Slot();
+		size_t j = next(i);
+		while(dist[j] > 1) {
+			new (&slots[i]) Slot(std::move(slots[j]));
+			slots[j].~Slot();
+			dist[i] = dist[j] - 1;
+			i = j;
+			j = next(j);
+		}
+		dist[i] = 0;
+		size--;
+	}
+	void clear(){
+		for(size_t i = 0; i < capacity; i++)
+			if(dist[i]) {
+				slots[i].~Slot();
+				dist[i] = 0;
+			}
+		size = 0;
+	}
+	/**
+	 * double the capacity
+	 */
+	void expand(){
+		rehash(capacity * 2);
+	}
+
+private:
+	void allocate(size_t n){
+		slots = static_cast<Slot *>(::operator new(n * sizeof(Slot)));
+		dist = new unsigned char[n]();
+		capacity = n;
+		shift = 64;
+		while(n > 1) {
+			n >>= 1;
+			shift--;
+		}
+	}
+	void deallocate(){
+		::operator delete(slots);
+		delete [] dist;
+		slots = nullptr;
+		dist = nullptr;
+		capacity = 0;
+	}
+	void copy_from(const robin_hood_core &other){
+		allocate(other.capacity);
+		for(size_t i = 0; i < capacity; i++)
+			if(other.dist[i]) {
+				new (&slots[i]) Slot(other.slots[i]);
+				dist[i] = other.dist[i];
+			}
+		size = other.size;
+	}
+	/**
+	 * growing only helps a long probe while the table is not sparse,
+	 * past that the hash function itself is broken
+	 */
+	void grow_for_probe(){
+		if(capacity / 64 > size)
+			throw std::length_error("robin hood table: probe length bound can't be met");
+		rehash(capacity * 2);
+	}
+	void grow_or_drop(Slot *carry){
+		try {
+			grow_for_probe();
+		}catch(...) {
+			carry->~Slot();
+			throw;
+		}
+	}
+	void rehash(size_t new_capacity){
+		Slot *old_slots = slots;
+		unsigned char *old_dist = dist;
+		size_t old_capacity = capacity;
+		expansions += new_capacity > old_capacity;
+		allocate(new_capacity);
+		size = 0;
+		for(size_t i = 0; i < old_capacity; i++)
+			if(old_dist[i]) {
+				insert_new(std::move(old_slots[i]));
+				old_slots[i].~Slot();
+			}
+		::operator delete(old_slots);
+		delete [] old_dist;
+	}
+};
+
+}
+
+#endif
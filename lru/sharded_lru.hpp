@@ -0,0 +1,283 @@
+#ifndef SJTU_SHARDED_LRU_HPP
+#define SJTU_SHARDED_LRU_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include "lru.hpp"
+#include "read_buffer.hpp"
+
+namespace sjtu {
+
+/**
+ * a basic_lru behind one mutex, every get and save takes it
+ */
+template<class Key, class T, class Hash, class Equal, class Table, class Policy>
+class locked_lru{
+	using value_type = sjtu::pair<const Key, T>;
+	std::mutex lock;
+	basic_lru<Key,T,Hash,Equal,Table,Policy> memory;
+public:
+	locked_lru():memory(0){}
+	void set_capacity(size_t size) {
+		memory.c = size;
+	}
+	template<class V>
+	void save(V &&v) {
+		std::lock_guard<std::mutex> guard(lock);
+		memory.save(std::forward<V>(v));
+	}
+	template<class F>
+	bool visit(const Key &key, F f) {
+		std::lock_guard<std::mutex> guard(lock);
+		const T *value = memory.get(key);
+		if(!value)
+			return false;
+		f(*value);
+		return true;
+	}
+	size_t size() {
+		std::lock_guard<std::mutex> guard(lock);
+		return memory.map.size();
+	}
+	cache_stats stats() {
+		std::lock_guard<std::mutex> guard(lock);
+		return memory.stats();
+	}
+	void collect_latency(op_latency &into) {
+		std::lock_guard<std::mutex> guard(lock);
+		into.merge(memory.latency);
+	}
+	void clear() {
+		std::lock_guard<std::mutex> guard(lock);
+		memory.clear();
+	}
+	void maintain() {}
+};
+
+/**
+ * a basic_lru whose hits don't write: a reader finds the node under
+ * a shared lock and only records it in a read_buffer, the recorded
+ * nodes are moved to the end of the order later, in one batch, by
+ * whoever holds the lock exclusively (a save, a reader that found
+ * its ring full, or maintain()).
+ * every change to the map drains first, so a recorded node is never
+ * removed before it is applied.
+ * a policy with shared hits (the clock ones) needs no buffer: its
+ * on_hit runs right away under the shared lock.
+ * misses are recorded the same way, as the hash of the key, for a
+ * policy with hashed misses (tinylfu) and replayed through its
+ * on_miss_hashed; any other policy's on_miss is not called here (the
+ * others in policy.hpp do nothing on a miss).
+ */
+template<class Key, class T, class Hash, class Equal, class Table, class Policy>
+class buffered_lru{
+	using value_type = sjtu::pair<const Key, T>;
+	using iterator = typename basic_lru<Key,T,Hash,Equal,Table,Policy>::iterator;
+	using token = decltype(iterator().current);
+	std::shared_mutex lock;
+	basic_lru<Key,T,Hash,Equal,Table,Policy> memory;
+	read_buffer<token> accesses;
+	// hashes of the missed keys, for a policy with hashed misses only
+	typename std::conditional<has_hashed_misses<Policy>::value, read_buffer<size_t>, no_meta>::type misses;
+	striped_stats<> reads; // the hits and misses of visit, which skips memory.get
+public:
+	buffered_lru():memory(0){}
+	void set_capacity(size_t size) {
+		memory.c = size;
+	}
+	template<class V>
+	void save(V &&v) {
+		std::unique_lock<std::shared_mutex> guard(lock);
+		drain();
+		memory.save(std::forward<V>(v));
+	}
+	template<class F>
+	bool visit(const Key &key, F f) {
+		bool full = false, found = false;
+		{
+			std::shared_lock<std::shared_mutex> guard(lock);
+			iterator it = memory.map.find(key);
+			if(it == memory.map.end()) {
+				reads.miss();
+				if constexpr (has_hashed_misses<Policy>::value)
+					full = !misses.record(memory.map.hash(key));
+			}else {
+				reads.hit();
+				f(static_cast<const T &>(it->second));
+				if constexpr (has_shared_hits<Policy>::value)
+					memory.policy.on_hit(memory, it);
+				else
+					full = !accesses.record(it.current);
+				found = true;
+			}
+		}
+		// the ring was full: drain if nobody else is in there,
+		// otherwise the access is just lost
+		if(full && lock.try_lock()) {
+			drain();
+			lock.unlock();
+		}
+		return found;
+	}
+	size_t size() {
+		std::shared_lock<std::shared_mutex> guard(lock);
+		return memory.map.size();
+	}
+	cache_stats stats() {
+		std::unique_lock<std::shared_mutex> guard(lock);
+		cache_stats s = memory.stats();
+		reads.add_to(s);
+		return s;
+	}
+	/**
+	 * saves and clears only, visit is not timed
+	 */
+	void collect_latency(op_latency &into) {
+		std::unique_lock<std::shared_mutex> guard(lock);
+		into.merge(memory.latency);
+	}
+	void clear() {
+		std::unique_lock<std::shared_mutex> guard(lock);
+		accesses.discard();
+		if constexpr (has_hashed_misses<Policy>::value)
+			misses.discard();
+		memory.clear();
+	}
+	/**
+	 * apply the recorded accesses now, e.g. from a maintenance thread
+	 */
+	void maintain() {
+		std::unique_lock<std::shared_mutex> guard(lock);
+		drain();
+	}
+private:
+	void drain() {
+		accesses.drain([this](token t){ memory.policy.on_hit(memory, iterator_at(t)); });
+		if constexpr (has_hashed_misses<Policy>::value)
+			misses.drain([this](size_t h){ memory.policy.on_miss_hashed(memory, h); });
+	}
+	iterator iterator_at(token t) {
+		if constexpr (std::is_same<Table, compact_table>::value)
+			return memory.map.iterator_of(t);
+		else
+			return iterator(t);
+	}
+};
+
+/**
+ * a thread-safe lru made of N independent basic_lru shards.
+ * a key always goes to the same shard, picked by high bits of its
+ * mixed hash (the buckets inside a shard use the low ones), and each
+ * shard has its own lock and capacity / N of the capacity.
+ * so the eviction order is per shard: the least recently used key
+ * of the shard a new key lands in is the one dropped.
+ * with ReadBuffered the shards are buffered_lru: hits take the shard
+ * lock shared and their recency is applied in batches (or at once,
+ * for a policy with shared hits), otherwise they are locked_lru.
+ * Policy is every shard's eviction policy (see policy.hpp).
+ * values never leave a shard by pointer: get copies the value out,
+ * visit lets a function read it while the shard is locked.
+ */
+template<
+	class Key,
+	class T,
+	class Hash = std::hash<Key>,
+	class Equal = std::equal_to<Key>,
+	size_t N = 16,
+	class Table = chained_table,
+	bool ReadBuffered = false,
+	class Policy = lru_policy
+> class sharded_lru{
+	static_assert(N && !(N & (N - 1)) && N <= (1u << 24), "N must be a power of two, at most 2^24");
+	using value_type = sjtu::pair<const Key, T>;
+	using shard_cache = typename std::conditional<ReadBuffered,
+		buffered_lru<Key,T,Hash,Equal,Table,Policy>, locked_lru<Key,T,Hash,Equal,Table,Policy>>::type;
+	/**
+	 * one cache line or more each, so two locks never share a line
+	 */
+	struct alignas(64) shard :public shard_cache{};
+	shard shards[N];
+	Hash hash_function;
+public:
+	sharded_lru(size_t size){
+		for(size_t i = 0; i < N; i++)
+			shards[i].set_capacity(size / N + (i < size % N ? 1 : 0));
+	}
+	sharded_lru(const sharded_lru &) = delete;
+	sharded_lru & operator=(const sharded_lru &) = delete;
+
+	void save(const value_type &v) {
+		shard_of(v.first).save(v);
+	}
+	void save(value_type &&v) {
+		shard_of(v.first).save(std::move(v));
+	}
+	/**
+	 * copy the value of key into out and mark it used,
+	 * return false (out untouched) if it is not cached
+	 */
+	bool get(const Key &key, T &out) {
+		return shard_of(key).visit(key, [&out](const T &value){ out = value; });
+	}
+	/**
+	 * call f(const T &) on the value of key and mark it used,
+	 * without copying it; f runs with the shard locked, so it must
+	 * not keep the reference or call back into this lru
+	 */
+	template<class F>
+	bool visit(const Key &key, F f) {
+		return shard_of(key).visit(key, f);
+	}
+	/**
+	 * the number of cached elements, each shard is counted
+	 * under its own lock, not all at the same moment
+	 */
+	size_t size() {
+		size_t total = 0;
+		for(size_t i = 0; i < N; i++)
+			total += shards[i].size();
+		return total;
+	}
+	void clear() {
+		for(size_t i = 0; i < N; i++)
+			shards[i].clear();
+	}
+	/**
+	 * the counters of all shards added up, each read under its
+	 * shard's lock (see stats.hpp)
+	 */
+	cache_stats stats() {
+		cache_stats total;
+		for(size_t i = 0; i < N; i++)
+			total += shards[i].stats();
+		return total;
+	}
+	/**
+	 * merge the latency histograms of all shards into into (see
+	 * latency.hpp; nothing without SJTU_LATENCY). the time a get or
+	 * save waits for its shard's lock is not in them.
+	 */
+	void collect_latency(op_latency &into) {
+		for(size_t i = 0; i < N; i++)
+			shards[i].collect_latency(into);
+	}
+	/**
+	 * drain the read buffers of every shard,
+	 * nothing to do without ReadBuffered
+	 */
+	void maintain() {
+		for(size_t i = 0; i < N; i++)
+			shards[i].maintain();
+	}
+private:
+	shard &shard_of(const Key &key) {
+		return shards[(mix_hashing::mix(hash_function(key)) >> 40) & (N - 1)];
+	}
+};
+
+}
+
+#endif
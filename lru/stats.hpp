@@ -0,0 +1,165 @@
+#ifndef SJTU_STATS_HPP
+#define SJTU_STATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <thread>
+#include "hashing.hpp"
+#include "weigher.hpp"
+
+namespace sjtu {
+
+/**
+ * what a cache has done so far, read out of its counters at once.
+ * saves count every save, updates the ones whose key was there
+ * already; bytes_evicted adds up byte_weigher of the evicted elements
+ * whatever the cache's own weigher is; expands is how many times the
+ * index grew.
+ * snapshots of several shards add up with +=.
+ */
+struct cache_stats{
+	uint64_t hits, misses, saves, updates, evictions, expands, bytes_evicted;
+	cache_stats():hits(0), misses(0), saves(0), updates(0), evictions(0), expands(0), bytes_evicted(0){}
+	cache_stats & operator+=(const cache_stats &other){
+		hits += other.hits;
+		misses += other.misses;
+		saves += other.saves;
+		updates += other.updates;
+		evictions += other.evictions;
+		expands += other.expands;
+		bytes_evicted += other.bytes_evicted;
+		return *this;
+	}
+	/**
+	 * hits out of all gets, 0 before the first
+	 */
+	double hit_ratio() const {
+		return hits + misses ? double(hits) / double(hits + misses) : 0;
+	}
+	/**
+	 * one "name value" line per counter, then the hit ratio
+	 */
+	void print(std::ostream &os) const {
+		os << "hits " << hits << "\nmisses " << misses << "\nsaves " << saves
+		   << "\nupdates " << updates << "\nevictions " << evictions << "\nexpands " << expands
+		   << "\nbytes_evicted " << bytes_evicted << "\nhit_ratio " << hit_ratio() << "\n";
+	}
+	/**
+	 * the same as one JSON object, no newline
+	 */
+	void print_json(std::ostream &os) const {
+		os << "{\"hits\":" << hits << ",\"misses\":" << misses << ",\"saves\":" << saves
+		   << ",\"updates\":" << updates << ",\"evictions\":" << evictions << ",\"expands\":" << expands
+		   << ",\"bytes_evicted\":" << bytes_evicted << ",\"hit_ratio\":" << hit_ratio() << "}";
+	}
+};
+
+#ifndef SJTU_NO_STATS
+
+/**
+ * the counters of one cache (one shard of a sharded one): plain
+ * integers, written by whoever holds the cache, so counting is one
+ * non-atomic add; they are read under the same lock as the rest of
+ * the cache. a line of their own, so a shard's counters never share
+ * one with another shard's.
+ * define SJTU_NO_STATS to compile every counter out, snapshots are
+ * then all zeros.
+ */
+struct alignas(64) stats_counters{
+	uint64_t hits, misses, saves, updates, evictions, bytes_evicted;
+	stats_counters():hits(0), misses(0), saves(0), updates(0), evictions(0), bytes_evicted(0){}
+	void hit(){
+		hits++;
+	}
+	void miss(){
+		misses++;
+	}
+	void save(bool update){
+		saves++;
+		updates += update;
+	}
+	/**
+	 * an element is evicted; byte_weigher runs only here, so it
+	 * costs nothing with SJTU_NO_STATS
+	 */
+	template<class Key, class T>
+	void evict(const Key &key, const T &value){
+		evictions++;
+		bytes_evicted += byte_weigher()(key, value);
+	}
+	cache_stats snapshot(uint64_t expands) const {
+		cache_stats s;
+		s.hits = hits;
+		s.misses = misses;
+		s.saves = saves;
+		s.updates = updates;
+		s.evictions = evictions;
+		s.expands = expands;
+		s.bytes_evicted = bytes_evicted;
+		return s;
+	}
+};
+
+/**
+ * hits and misses of readers that share a cache (a shared lock):
+ * each thread adds to the stripe its id hashes to (as read_buffer
+ * picks its ring), a relaxed atomic add on a line that is almost
+ * never contended; read by summing the stripes.
+ */
+template<size_t Stripes = 16>
+class striped_stats{
+	struct alignas(64) stripe{
+		std::atomic<uint64_t> hits, misses;
+		stripe():hits(0), misses(0){}
+	};
+	stripe stripes[Stripes];
+	static size_t mine(){
+		static thread_local size_t id = mix_hashing::mix(std::hash<std::thread::id>()(std::this_thread::get_id()));
+		return id & (Stripes - 1);
+	}
+public:
+	void hit(){
+		stripes[mine()].hits.fetch_add(1, std::memory_order_relaxed);
+	}
+	void miss(){
+		stripes[mine()].misses.fetch_add(1, std::memory_order_relaxed);
+	}
+	/**
+	 * add the hits and misses into s
+	 */
+	void add_to(cache_stats &s) const {
+		for(size_t i = 0; i < Stripes; i++) {
+			s.hits += stripes[i].hits.load(std::memory_order_relaxed);
+			s.misses += stripes[i].misses.load(std::memory_order_relaxed);
+		}
+	}
+};
+
+#else
+
+struct stats_counters{
+	void hit(){}
+	void miss(){}
+	void save(bool){}
+	template<class Key, class T>
+	void evict(const Key &, const T &){}
+	cache_stats snapshot(uint64_t) const {
+		return cache_stats();
+	}
+};
+
+template<size_t Stripes = 16>
+class striped_stats{
+public:
+	void hit(){}
+	void miss(){}
+	void add_to(cache_stats &) const {}
+};
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef SJTU_SWISS_TABLE_HPP
+#define SJTU_SWISS_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+#if defined(__SSE2__) && !defined(SJTU_NO_SSE2)
+#include <emmintrin.h>
+#define SJTU_SWISS_SSE2
+#endif
+
+namespace sjtu {
+
+/**
+ * table tag, see hashing.hpp for the default chained_table
+ * swiss_table: open addressing with a control byte per slot
+ */
+struct swiss_table {};
+
+/**
+ * the control bytes of one group of 16 slots.
+ * a full slot keeps the top 7 bits of its mixed hash (h2), empty and
+ * deleted slots have the sign bit set, so one byte compare per slot
+ * tells which slots may hold a key, and a key is only compared with
+ * Equal when its h2 matches.
+ */
+struct swiss_group{
+	static const size_t width = 16;
+	static const int8_t empty = -128; // 0b10000000
+	static const int8_t deleted = -2; // 0b11111110
+#ifdef SJTU_SWISS_SSE2
+	__m128i ctrl;
+	explicit swiss_group(const int8_t *pos):ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pos))){}
+	/**
+	 * bit i is set if slot i has this h2
+	 */
+	unsigned match(int8_t h2) const {
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+	}
+	unsigned match_empty() const {
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(empty), ctrl));
+	}
+	unsigned match_empty_or_deleted() const {
+		return _mm_movemask_epi8(ctrl);
+	}
+#else
+	const int8_t *ctrl;
+	explicit swiss_group(const int8_t *pos):ctrl(pos){}
+	unsigned match(int8_t h2) const {
+		unsigned mask = 0;
+		for(size_t i = 0; i < width; i++)
+			if(ctrl[i] == h2)
+				mask |= 1u << i;
+		return mask;
+	}
+	unsigned match_empty() const {
+		return match(empty);
+	}
+	unsigned match_empty_or_deleted() const {
+		unsigned mask = 0;
+		for(size_t i = 0; i < width; i++)
+			if(ctrl[i] < 0)
+				mask |= 1u << i;
+		return mask;
+	}
+#endif
+};
+
+/**
+ * an open addressing table in the style of abseil's swiss table.
+ * slots come in aligned groups of 16 probed quadratically group by
+ * group; a lookup stops at the first group with an empty slot.
+ * a removed slot becomes empty again when its group still has an
+ * empty slot (then no probe ever went past it), otherwise it is
+ * marked deleted until the next rehash.
+ */
+template<class Slot, class Key, class KeyOf, class Hash, class Equal>
+class swiss_core{
+public:
+	static const size_t npos = size_t(-1);
+	static const size_t width = swiss_group::width;
+	static const size_t initial_capacity = 16;
+
+	Slot *slots;
+	int8_t *ctrl;
+	size_t capacity; // a power of two, at least one group
+	size_t shift; // 64 - 7 - log2(capacity / width)
+	size_t growth_left; // empty slots left before the load reaches 7/8
+	size_t size; // record the number of elements
+	size_t expansions; // times the capacity grew
+	Hash hash_function;
+	Equal equal_function;
+	KeyOf key_of;
+	// --------------------------
+	swiss_core():slots(nullptr), ctrl(nullptr), capacity(0), shift(0), growth_left(0), size(0), expansions(0){
+		allocate(initial_capacity);
+	}
+	swiss_core(const swiss_core &other)
+		:slots(nullptr), ctrl(nullptr), capacity(0), shift(0), growth_left(0), size(0), expansions(0),
+		 hash_function(other.hash_function), equal_function(other.equal_function){
+		copy_from(other);
+	}
+	swiss_core & operator=(const swiss_core &other){
+		if(this != &other) {
+			clear();
+			deallocate();
+			hash_function = other.hash_function;
+			equal_function = other.equal_function;
+			copy_from(other);
+		}
+		return *this;
+	}
+	~swiss_core(){
+		clear();
+		deallocate();
+	}
+
+	unsigned long long mix(const Key &key) const {
+		return mix_of(hash_function(key));
+	}
+	static unsigned long long mix_of(size_t hash_value) {
+		return static_cast<unsigned long long>(hash_value) * 11400714819323198485ull;
+	}
+	static int8_t h2(unsigned long long h) {
+		return static_cast<int8_t>(h >> 57);
+	}
+	size_t first_group(unsigned long long h) const {
+		return (h >> shift) & (capacity / width - 1);
+	}
+	size_t next_group(size_t group, size_t step) const {
+		return (group + step) & (capacity / width - 1);
+	}
+	/**
+	 * the first slot on the probe sequence of key whose h2 matches
+	 * and which satisfies pred, npos if there is none
+	 */
+	template<class Pred>
+	size_t find_if(const Key &key, Pred pred) const {
+		return find_hashed(hash_function(key), pred);
+	}
+	/**
+	 * find_if and insert_new on a hash_function value computed
+	 * by the caller, so a lookup and the insert after it hash once
+	 */
+	template<class Pred>
+	size_t find_hashed(size_t hash_value, Pred pred) const {
+		unsigned long long h = mix_of(hash_value);
+		int8_t tag = h2(h);
+		size_t group = first_group(h);
+		for(size_t step = 1; ; step++) {
+			swiss_group g(ctrl + group * width);
+			for(unsigned mask = g.match(tag); mask; mask &= mask - 1) {
+				size_t i = group * width + __builtin_ctz(mask);
+				if(pred(slots[i]))
+					return i;
+			}
+			if(g.match_empty() || step > capacity / width)
+				return npos;
+			group = next_group(group, step);
+		}
+	}
+	/**
+	 * bring the first group probed for hash_value into the cache
+	 */
+	void prefetch(size_t hash_value) const {
+		size_t group = first_group(mix_of(hash_value));
+		__builtin_prefetch(ctrl + group * width);
+		__builtin_prefetch(slots + group * width);
+	}
+	/**
+	 * the slot holding key, npos if not found
+	 */
+	size_t find_index(const Key &key) const {
+		return find_if(key, [&](const Slot &slot){ return equal_function(key_of(slot), key); });
+	}
+	/**
+	 * insert an element whose key is not in the table yet,
+	 * return the slot it ends up in
+	 */
+	size_t insert_new(Slot &&value){
+		return insert_hashed(hash_function(key_of(value)), std::move(value));
+	}
+	size_t insert_hashed(size_t hash_value, Slot &&value){
+		unsigned long long h = mix_of(hash_value);
+		size_t i = find_free(h);
+		if(!growth_left && ctrl[i] == swiss_group::empty) {
+			rehash(size * 16 <= capacity * 7 ? capacity : capacity * 2);
+			i = find_free(h);
+		}
+		if(ctrl[i] == swiss_group::empty)
+			growth_left--;
+		new (&slots[i]) Slot(std::move(value));
+		ctrl[i] = h2(h);
+		size++;
+		return i;
+	}
+	void erase_at(size_t i){
+		slots[i].~Slot();
+		size_t group = i / width;
+		if(swiss_group(ctrl + group * width).match_empty()) {
+			ctrl[i] = swiss_group::empty;
+			growth_left++;
+		}else
+			ctrl[i] = swiss_group::deleted;
+		size--;
+	}
+	void clear(){
+		for(size_t i = 0; i < capacity; i++)
+			if(ctrl[i] >= 0)
+				slots[i].~Slot();
+		std::memset(ctrl, swiss_group::empty, capacity);
+		growth_left = capacity / 8 * 7;
+		size = 0;
+	}
+	/**
+	 * double the capacity
+	 */
+	void expand(){
+		rehash(capacity * 2);
+	}
+
+private:
+	size_t find_free(unsigned long long h) const {
+		size_t group = first_group(h);
+		for(size_t step = 1; ; step++) {
+			unsigned mask = swiss_group(ctrl + group * width).match_empty_or_deleted();
+			if(mask)
+				return group * width + __builtin_ctz(mask);
+			group = next_group(group, step);
+		}
+	}
+	void allocate(size_t n){
+		slots = static_cast<Slot *>(::operator new(n * sizeof(Slot)));
+		ctrl = new int8_t[n];
+		std::memset(ctrl, swiss_group::empty, n);
+		capacity = n;
+		growth_left = n / 8 * 7;
+		shift = 57;
+		for(n /= width; n > 1; n >>= 1)
+			shift--;
+	}
+	void deallocate(){
+		::operator delete(slots);
+		delete [] ctrl;
+		slots = nullptr;
+		ctrl = nullptr;
+		capacity = 0;
+	}
+	void copy_from(const swiss_core &other){
+		allocate(other.capacity);
+		for(size_t i = 0; i < capacity; i++)
+			if(other.ctrl[i] >= 0)
+				new (&slots[i]) Slot(other.slots[i]);
+		std::memcpy(ctrl, other.ctrl, capacity);
+		growth_left = other.growth_left;
+		size = other.size;
+	}
+	/**
+	 * move everything into a fresh table of new_capacity slots,
+	 * this also drops all deleted marks
+	 */
+	void rehash(size_t new_capacity){
+		Slot *old_slots = slots;
+		int8_t *old_ctrl = ctrl;
+		size_t old_capacity = capacity;
+		expansions += new_capacity > old_capacity;
+		allocate(new_capacity);
+		for(size_t i = 0; i < old_capacity; i++)
+			if(old_ctrl[i] >= 0) {
+				unsigned long long h = mix(key_of(old_slots[i]));
+				size_t j = find_free(h);
+				new (&slots[j]) Slot(std::move(old_slots[i]));
+				old_slots[i].~Slot();
+				ctrl[j] = h2(h);
+				growth_left--;
+			}
+		::operator delete(old_slots);
+		delete [] old_ctrl;
+	}
+};
+
+}
+
+#endif
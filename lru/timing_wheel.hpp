@@ -0,0 +1,213 @@
+#ifndef SJTU_TIMING_WHEEL_HPP
+#define SJTU_TIMING_WHEEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sjtu {
+
+/**
+ * a hierarchical timing wheel (Varghese and Lauck) of timers that
+ * each carry an Id: 4 levels of 64 slots, a slot of level l covering
+ * 64^l ticks, so a deadline up to 64^4 ticks ahead (4.6 hours of
+ * 1 ms ticks) goes straight into the slot it is due in; a later one
+ * waits in the last level and is placed again when the wheel turns
+ * over. when the wheel's time crosses into a new 64-tick block, the
+ * slot of the next level that covers it is spread over the lower
+ * levels (cascading).
+ * schedule, reschedule and cancel are O(1): a timer is an entry of a
+ * vector, linked into its slot's list, and a cancelled entry is
+ * reused by the next schedule.
+ * advance(now, limit, f) hands the ids of the timers due by now to f,
+ * at most limit of them per call, and skips empty stretches of time
+ * a block at a time.
+ */
+template<class Id>
+class timing_wheel{
+public:
+	static const uint32_t none = uint32_t(-1);
+private:
+	static const unsigned levels = 4;
+	static const unsigned bits = 6;
+	static const uint32_t slots = 1u << bits;
+	struct entry{
+		Id id;
+		uint64_t deadline;
+		uint32_t prev, next; // in its slot, or next in the free list
+		uint32_t slot; // level * slots + index
+	};
+	std::vector<entry> entries;
+	uint32_t free_list;
+	uint32_t head[levels * slots];
+	size_t count[levels];
+	uint64_t current; // every timer due by current was handed out
+public:
+	timing_wheel():free_list(none), current(0){
+		for(uint32_t i = 0; i < levels * slots; i++)
+			head[i] = none;
+		for(unsigned l = 0; l < levels; l++)
+			count[l] = 0;
+	}
+	timing_wheel(const timing_wheel &) = delete;
+	timing_wheel & operator=(const timing_wheel &) = delete;
+
+	size_t size() const {
+		size_t total = 0;
+		for(unsigned l = 0; l < levels; l++)
+			total += count[l];
+		return total;
+	}
+	/**
+	 * the time the wheel is at, every later deadline is still ahead
+	 */
+	uint64_t time() const {
+		return current;
+	}
+	/**
+	 * move an empty wheel to now without handing anything out
+	 */
+	void start(uint64_t now){
+		if(!size())
+			current = now;
+	}
+	/**
+	 * return the timer, due at deadline (a deadline already past
+	 * is due on the next tick)
+	 */
+	uint32_t schedule(const Id &id, uint64_t deadline){
+		uint32_t t = free_list;
+		if(t == none) {
+			t = uint32_t(entries.size());
+			entries.push_back(entry());
+		}else
+			free_list = entries[t].next;
+		entries[t].id = id;
+		entries[t].deadline = deadline;
+		place(t, current + 1);
+		return t;
+	}
+	void reschedule(uint32_t t, uint64_t deadline){
+		unlink(t);
+		entries[t].deadline = deadline;
+		place(t, current + 1);
+	}
+	void cancel(uint32_t t){
+		unlink(t);
+		entries[t].next = free_list;
+		free_list = t;
+	}
+	/**
+	 * move the wheel's time on towards now and call f(id) for every
+	 * timer that falls due, each is cancelled first; stop after
+	 * limit of them, the rest is handed out by the next call.
+	 * return the number handed out.
+	 */
+	template<class F>
+	size_t advance(uint64_t now, size_t limit, F f){
+		size_t done = 0;
+		while(current < now && done < limit) {
+			unsigned lowest = 0;
+			while(lowest < levels && !count[lowest])
+				lowest++;
+			if(lowest == levels) {
+				current = now;
+				break;
+			}
+			uint64_t tick = current + 1;
+			uint64_t mask = (uint64_t(1) << (bits * lowest)) - 1;
+			if(tick & mask) {
+				// nothing is due before the next block of level lowest
+				current = (tick | mask) < now ? (tick | mask) : now;
+				continue;
+			}
+			cascade(tick);
+			uint32_t &first = head[tick & (slots - 1)];
+			while(first != none && done < limit) {
+				uint32_t t = first;
+				Id id = entries[t].id;
+				cancel(t);
+				f(id);
+				done++;
+			}
+			if(first != none)
+				break;
+			current = tick;
+		}
+		return done;
+	}
+	/**
+	 * drop every timer, the time stays
+	 */
+	void clear(){
+		entries.clear();
+		free_list = none;
+		for(uint32_t i = 0; i < levels * slots; i++)
+			head[i] = none;
+		for(unsigned l = 0; l < levels; l++)
+			count[l] = 0;
+	}
+private:
+	/**
+	 * link timer t into the slot it is due in, first being the
+	 * first tick not handed out yet: the level is the highest 6-bit
+	 * digit in which its tick and first differ, so the slot is
+	 * cascaded (or handed out, on level 0) right when its block
+	 * starts
+	 */
+	void place(uint32_t t, uint64_t first){
+		uint64_t due = entries[t].deadline > first ? entries[t].deadline : first;
+		uint64_t differ = due ^ first;
+		unsigned level = differ ? (63 - __builtin_clzll(differ)) / bits : 0;
+		uint32_t index = uint32_t((due >> (bits * level)) & (slots - 1));
+		if(level >= levels) {
+			// too far: wait in the last level's slot 0, cascaded when
+			// the wheel turns over, and be placed again then
+			level = levels - 1;
+			index = 0;
+		}
+		uint32_t slot = level * slots + index;
+		entry &e = entries[t];
+		e.slot = slot;
+		e.prev = none;
+		e.next = head[slot];
+		if(e.next != none)
+			entries[e.next].prev = t;
+		head[slot] = t;
+		count[level]++;
+	}
+	void unlink(uint32_t t){
+		entry &e = entries[t];
+		if(e.prev != none)
+			entries[e.prev].next = e.next;
+		else
+			head[e.slot] = e.next;
+		if(e.next != none)
+			entries[e.next].prev = e.prev;
+		count[e.slot / slots]--;
+	}
+	/**
+	 * tick starts a block of 64^l ticks for every level l whose index
+	 * bits below are all 0: spread that level's slot for tick over the
+	 * lower ones, the highest level first
+	 */
+	void cascade(uint64_t tick){
+		unsigned top = 0;
+		while(top + 1 < levels && !(tick & ((uint64_t(1) << (bits * (top + 1))) - 1)))
+			top++;
+		for(unsigned level = top; level > 0; level--) {
+			uint32_t slot = level * slots + uint32_t((tick >> (bits * level)) & (slots - 1));
+			uint32_t t = head[slot];
+			while(t != none) {
+				uint32_t next = entries[t].next;
+				unlink(t);
+				place(t, tick);
+				t = next;
+			}
+		}
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SJTU_WEIGHER_HPP
+#define SJTU_WEIGHER_HPP
+
+#include <cstddef>
+#include <vector>
+#include "utility.hpp"
+#include "class-matrix.hpp"
+
+namespace sjtu {
+
+/**
+ * weighers of basic_lru: weigher(key, value) is what an element
+ * costs out of the capacity c, and the cache evicts until the
+ * weights add up to c at most.
+ * a weigher must give an element the same weight as long as its
+ * value isn't replaced, the cache keeps the running total.
+ */
+
+/**
+ * every element weighs 1: c is a number of elements. the default.
+ */
+struct unit_weigher{
+	template<class Key, class T>
+	size_t operator()(const Key &, const T &) const {
+		return 1;
+	}
+};
+
+/**
+ * the bytes a value owns outside of itself: nothing unless it is
+ * one of the types below
+ */
+template<class T>
+size_t heap_bytes(const T &) {
+	return 0;
+}
+/**
+ * a Matrix owns its rows, each a std::vector of ColSize() elements
+ */
+template<class U>
+size_t heap_bytes(const Matrix<U> &m) {
+	return m.RowSize() * m.ColSize() * sizeof(U) + m.RowSize() * sizeof(std::vector<U>);
+}
+
+/**
+ * an element weighs its bytes: the key and value themselves plus
+ * what they own (heap_bytes), so c is a byte budget.
+ * the node and index around them are not counted.
+ */
+struct byte_weigher{
+	template<class Key, class T>
+	size_t operator()(const Key &key, const T &value) const {
+		return sizeof(pair<const Key, T>) + heap_bytes(key) + heap_bytes(value);
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,239 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+// hashmap, linked_hashmap and lru on swiss_table:
+// the workloads of 1.cpp, 4.cpp and 8.cpp, then long runs of inserts
+// and removes checked against std::unordered_map, with keys hashed
+// sixteen to a value so that long runs form and most removes shift
+// some of them back
+
+typedef sjtu::swiss_table table;
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: hashmap insert & remove & find",
+    "test2: hashmap constructor(), =",
+    "test3: hashmap erase-heavy",
+    "test4: linked_hashmap order",
+    "test5: linked_hashmap erase-heavy",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+    "test6: lru",
+    "test7: memcheck",
+};
+
+struct clustered_hash{
+    size_t operator()(int key) const {
+        return size_t(key / 16);
+    }
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+template<class Map>
+void check_1cpp(Map &map, int n){
+    for(int i=0;i<n;i++){
+        auto it = map.find(i);
+        if(i%3==0){
+            if(it != map.end())
+                fail();
+        }
+        else if(it == map.end() || (*it).second != (i%4==0 ? 4*i : i))
+            fail();
+    }
+}
+
+void hashmap_tester(){
+    using value_type = sjtu::pair<int,int>;
+    using mp = sjtu::hashmap<int,int,std::hash<int>,std::equal_to<int>,table>;
+    const int n = 100000;
+    std::cout<<c[2];
+    mp map;
+    for(int i=0;i<n;i++)
+        map.insert(value_type(i,i));
+    for(int i=0;i<n;i+=4)
+        map.insert(value_type(i,4*i));
+    for(int i=0;i<n;i+=3)
+        map.remove(i);
+    check_1cpp(map, n);
+    std::cout<<c[0]<<std::endl;
+
+    std::cout<<c[3];
+    mp map2(map);
+    map2.clear();
+    map2 = map;
+    check_1cpp(map2, n);
+    map.clear();
+    map.clear();
+    std::cout<<c[0]<<std::endl;
+}
+
+/**
+ * phases of 4000 operations on keys [0, keys): mostly inserts, mostly
+ * removes, then half and half; every key and the size are checked
+ * against ref after each phase
+ */
+template<class Op>
+void churn(int keys, int phases, Op op){
+    unsigned x = 2024;
+    for(int p=0;p<phases;p++){
+        int insert_share = p%3==0 ? 3 : p%3==1 ? 1 : 2;
+        for(int r=0;r<4000;r++){
+            x = x*1103515245+12345;
+            int key = int((x>>8)%unsigned(keys));
+            op(key, int((x>>4)%4) < insert_share, p*4000+r);
+        }
+        op(-1, false, -1);
+    }
+}
+
+void hashmap_churn_tester(){
+    using value_type = sjtu::pair<int,int>;
+    using mp = sjtu::hashmap<int,int,clustered_hash,std::equal_to<int>,table>;
+    const int keys = 2048;
+    std::cout<<c[4];
+    mp map;
+    std::unordered_map<int,int> ref;
+    size_t tombstones = 0;
+    churn(keys, 12, [&](int key, bool insert, int value){
+        if(key < 0) {
+            if(map.size != ref.size())
+                fail();
+            for(int k=0;k<keys;k++){
+                auto it = map.find(k);
+                auto rit = ref.find(k);
+                if((it == map.end()) != (rit == ref.end()))
+                    fail();
+                if(rit != ref.end() && (*it).second != rit->second)
+                    fail();
+            }
+            return;
+        }
+        if(insert){
+            map.insert(value_type(key,value));
+            ref[key] = value;
+            return;
+        }
+        size_t i = map.find_index(key);
+        if(map.remove(key) != (ref.erase(key) == 1))
+            fail();
+        if(i != mp::npos && map.ctrl[i] == sjtu::swiss_group::deleted)
+            tombstones++;
+    });
+    if(!tombstones)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+void linked_hashmap_tester(){
+    using value_type = sjtu::pair<int,int>;
+    using mp = sjtu::linked_hashmap<int,int,std::hash<int>,std::equal_to<int>,table>;
+    const int n = 100;
+    std::cout<<c[5]<<std::endl;
+    mp map;
+    for(int i=0;i<n;i++)
+        map.insert(value_type(i,i));
+    for(mp::iterator it = map.begin();it!=map.end();it++){
+        mp::iterator tmpit = it;
+        it++;
+        map.remove(tmpit);
+        if(it == map.end())
+            break;
+        it++;
+        if(it == map.end())
+            break;
+    }
+    for(int i=0;i<n;i+=4)
+        map.insert(value_type(i,4*i));
+    int ct = 0;
+    for(int i=0;i<n;i++)
+        ct += map.count(i);
+    std::cout<<"count: "<<ct<<std::endl;
+    for(mp::iterator it = map.begin();it!=map.end();it++)
+        std::cout<<(*it).first<<" "<<(*it).second<<std::endl;
+    mp map2(map);
+    map2 = map;
+    mp::const_iterator cit = map2.cbegin();
+    for(mp::iterator it = map.begin();it!=map.end();it++,cit++)
+        if(cit == map2.cend() || (*cit).first != (*it).first || (*cit).second != (*it).second)
+            fail();
+    if(cit != map2.cend())
+        fail();
+}
+
+/**
+ * as hashmap_churn_tester, and the order has to be the order of the
+ * last inserts: stamp[key] is when key was last inserted
+ */
+void linked_hashmap_churn_tester(){
+    using value_type = sjtu::pair<int,int>;
+    using mp = sjtu::linked_hashmap<int,int,clustered_hash,std::equal_to<int>,table>;
+    const int keys = 2048;
+    std::cout<<c[6];
+    mp map;
+    std::unordered_map<int,int> ref;
+    churn(keys, 12, [&](int key, bool insert, int value){
+        if(key < 0) {
+            if(map.size() != ref.size())
+                fail();
+            int last = -1;
+            size_t seen = 0;
+            for(mp::iterator it = map.begin();it!=map.end();it++,seen++){
+                auto rit = ref.find((*it).first);
+                if(rit == ref.end() || rit->second != (*it).second || rit->second <= last)
+                    fail();
+                last = rit->second;
+            }
+            if(seen != ref.size())
+                fail();
+            return;
+        }
+        if(insert){
+            map.insert(value_type(key,value));
+            ref[key] = value;
+            return;
+        }
+        mp::iterator it = map.find(key);
+        if((it != map.end()) != (ref.erase(key) == 1))
+            fail();
+        if(it != map.end())
+            map.remove(it);
+    });
+    std::cout<<c[0]<<std::endl;
+}
+
+void lru_tester(){
+    using value_type = sjtu::pair<Integer,Matrix<int> >;
+    std::cout<<c[8]<<std::endl;
+    sjtu::basic_lru<Integer,Matrix<int>,Hash,Equal,table> tester(100);
+    const int n=10000;
+    for(int i=0;i<n;i++){
+        tester.save(value_type(Integer(i),Matrix<int>(2,2,i)));
+        tester.get(Integer(i-(i%99)));
+    }
+    tester.print();
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("10.out","w",stdout);
+#endif
+    hashmap_tester();
+    hashmap_churn_tester();
+    linked_hashmap_tester();
+    linked_hashmap_churn_tester();
+    lru_tester();
+    std::cout<<c[9];
+    if(Integer::counter != 0)
+        fail();
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[7]<<std::endl;
+}
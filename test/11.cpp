@@ -0,0 +1,7 @@
+// 10.cpp with the scalar swiss_group, the fallback where there is no
+// SSE2; the output is the same
+#define SJTU_NO_SSE2
+#include "10.cpp"
+#ifdef SJTU_SWISS_SSE2
+BOOM :)
+#endif
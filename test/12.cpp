@@ -0,0 +1,244 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <list>
+
+// linked_hashmap and lru on compact_table: the workloads of 4.cpp and
+// 8.cpp, then long runs of inserts and removes checked against
+// std::unordered_map, over more nodes than one arena chunk holds so
+// that freed handles are reused across chunks, and an lru of random
+// gets and saves checked against a std::list lru
+
+typedef sjtu::compact_table table;
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: handles",
+    "test2: lru against a std::list lru",
+    "test3: linked_hashmap order",
+    "test4: linked_hashmap erase-heavy",
+    "test5: lru",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+    "test6: memcheck",
+};
+
+struct clustered_hash{
+    size_t operator()(int key) const {
+        return size_t(key / 16);
+    }
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+/**
+ * phases of 4000 operations on keys [0, keys): mostly inserts, mostly
+ * removes, then half and half; every key and the size are checked
+ * against ref after each phase
+ */
+template<class Op>
+void churn(int keys, int phases, Op op){
+    unsigned x = 2024;
+    for(int p=0;p<phases;p++){
+        int insert_share = p%3==0 ? 3 : p%3==1 ? 1 : 2;
+        for(int r=0;r<4000;r++){
+            x = x*1103515245+12345;
+            int key = int((x>>8)%unsigned(keys));
+            op(key, int((x>>4)%4) < insert_share, p*4000+r);
+        }
+        op(-1, false, -1);
+    }
+}
+
+void linked_hashmap_tester(){
+    using value_type = sjtu::pair<int,int>;
+    using mp = sjtu::linked_hashmap<int,int,std::hash<int>,std::equal_to<int>,table>;
+    const int n = 100;
+    std::cout<<c[4]<<std::endl;
+    mp map;
+    for(int i=0;i<n;i++)
+        map.insert(value_type(i,i));
+    for(mp::iterator it = map.begin();it!=map.end();it++){
+        mp::iterator tmpit = it;
+        it++;
+        map.remove(tmpit);
+        if(it == map.end())
+            break;
+        it++;
+        if(it == map.end())
+            break;
+    }
+    for(int i=0;i<n;i+=4)
+        map.insert(value_type(i,4*i));
+    int ct = 0;
+    for(int i=0;i<n;i++)
+        ct += map.count(i);
+    std::cout<<"count: "<<ct<<std::endl;
+    for(mp::iterator it = map.begin();it!=map.end();it++)
+        std::cout<<(*it).first<<" "<<(*it).second<<std::endl;
+    mp map2(map);
+    map2 = map;
+    mp::const_iterator cit = map2.cbegin();
+    for(mp::iterator it = map.begin();it!=map.end();it++,cit++)
+        if(cit == map2.cend() || (*cit).first != (*it).first || (*cit).second != (*it).second)
+            fail();
+    if(cit != map2.cend())
+        fail();
+}
+
+/**
+ * as hashmap_churn_tester, and the order has to be the order of the
+ * last inserts: stamp[key] is when key was last inserted
+ */
+void linked_hashmap_churn_tester(){
+    using value_type = sjtu::pair<int,int>;
+    using mp = sjtu::linked_hashmap<int,int,clustered_hash,std::equal_to<int>,table>;
+    const int keys = 4096;
+    std::cout<<c[5];
+    mp map;
+    std::unordered_map<int,int> ref;
+    churn(keys, 12, [&](int key, bool insert, int value){
+        if(key < 0) {
+            if(map.size() != ref.size())
+                fail();
+            int last = -1;
+            size_t seen = 0;
+            for(mp::iterator it = map.begin();it!=map.end();it++,seen++){
+                auto rit = ref.find((*it).first);
+                if(rit == ref.end() || rit->second != (*it).second || rit->second <= last)
+                    fail();
+                last = rit->second;
+            }
+            if(seen != ref.size())
+                fail();
+            return;
+        }
+        if(insert){
+            map.insert(value_type(key,value));
+            ref[key] = value;
+            return;
+        }
+        mp::iterator it = map.find(key);
+        if((it != map.end()) != (ref.erase(key) == 1))
+            fail();
+        if(it != map.end())
+            map.remove(it);
+    });
+    std::cout<<c[0]<<std::endl;
+}
+
+/**
+ * a handle names its element until the element is removed, whatever
+ * else comes and goes; a freed handle is the next one handed out
+ */
+void handle_tester(){
+    using value_type = sjtu::pair<int,int>;
+    using mp = sjtu::linked_hashmap<int,int,std::hash<int>,std::equal_to<int>,table>;
+    const int n = 3000;
+    std::cout<<c[2];
+    mp map;
+    for(int i=0;i<n;i++)
+        map.insert(value_type(i,i));
+    mp::handle first = map.handle_of(map.find(5));
+    mp::handle last = map.handle_of(map.find(n-1));
+    for(int i=0;i<n;i+=2)
+        map.remove(map.find(i));
+    for(int i=n;i<2*n;i++)
+        map.insert(value_type(i,i));
+    for(int i=1;i<n;i+=4)
+        map.insert(value_type(i,-i));
+    if((*map.iterator_of(first)).first != 5 || (*map.iterator_of(first)).second != -5)
+        fail();
+    if((*map.iterator_of(last)).first != n-1 || (*map.iterator_of(last)).second != n-1)
+        fail();
+    map.remove(map.iterator_of(last));
+    if(map.handle_of(map.insert(value_type(-1,0)).first) != last)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+/**
+ * random gets and saves on a small lru, the result of every get and
+ * the order after every 1000 operations as a std::list lru has them
+ */
+void lru_churn_tester(){
+    using value_type = sjtu::pair<const int,int>;
+    using lru = sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,table>;
+    const int capacity = 64, keys = 256;
+    std::cout<<c[3];
+    lru tester(capacity);
+    std::list<int> order;
+    std::unordered_map<int,std::pair<int,std::list<int>::iterator> > ref;
+    unsigned x = 7;
+    for(int r=1;r<=40000;r++){
+        x = x*1103515245+12345;
+        int key = int((x>>8)%unsigned(keys));
+        auto rit = ref.find(key);
+        if((x>>4)%2){
+            int *got = tester.get(key);
+            if((got == nullptr) != (rit == ref.end()))
+                fail();
+            if(got){
+                if(*got != rit->second.first)
+                    fail();
+                order.splice(order.end(), order, rit->second.second);
+            }
+        }else{
+            tester.save(value_type(key,r));
+            if(rit != ref.end()){
+                rit->second.first = r;
+                order.splice(order.end(), order, rit->second.second);
+            }else{
+                if(ref.size() == size_t(capacity)){
+                    ref.erase(order.front());
+                    order.pop_front();
+                }
+                ref[key] = std::make_pair(r, order.insert(order.end(), key));
+            }
+        }
+        if(r%1000 == 0){
+            if(tester.map.size() != order.size())
+                fail();
+            std::list<int>::iterator oit = order.begin();
+            for(auto it = tester.map.begin();it!=tester.map.end();it++,oit++)
+                if((*it).first != *oit || (*it).second != ref[*oit].first)
+                    fail();
+        }
+    }
+    std::cout<<c[0]<<std::endl;
+}
+
+void lru_tester(){
+    using value_type = sjtu::pair<Integer,Matrix<int> >;
+    std::cout<<c[6]<<std::endl;
+    sjtu::basic_lru<Integer,Matrix<int>,Hash,Equal,table> tester(100);
+    const int n=10000;
+    for(int i=0;i<n;i++){
+        tester.save(value_type(Integer(i),Matrix<int>(2,2,i)));
+        tester.get(Integer(i-(i%99)));
+    }
+    tester.print();
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("12.out","w",stdout);
+#endif
+    handle_tester();
+    lru_churn_tester();
+    linked_hashmap_tester();
+    linked_hashmap_churn_tester();
+    lru_tester();
+    std::cout<<c[8];
+    if(Integer::counter != 0)
+        fail();
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[7]<<std::endl;
+}
@@ -0,0 +1,135 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include "concurrent_hashmap.hpp"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+// concurrent_hashmap under 8 threads which insert, remove, find and
+// expand the same keys at random, on 64 keys (every operation
+// contends) and on 4096. a key is only ever inserted with the value
+// value_of(key), so any other value found is a torn or freed node;
+// at the end the size has to be the successful inserts minus the
+// successful removes, and exactly that many keys have to be found.
+// meant to be run under ThreadSanitizer, and AddressSanitizer:
+//     g++ -std=c++17 -O1 -g -pthread -fsanitize=thread -I../lru 13.cpp
+//     g++ -std=c++17 -O1 -g -pthread -fsanitize=address,undefined -I../lru 13.cpp
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: 8 threads on 64 keys",
+    "test2: 8 threads on 4096 keys",
+    "test3: expand() called over and over",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+int value_of(int key){
+    return key*7+1;
+}
+
+/**
+ * every key in [0, keys) is looked up once: the values must be right
+ * and as many found as size() says
+ */
+void check_all(sjtu::concurrent_hashmap<int,int> &map, int keys){
+    size_t found = 0;
+    for(int k=0;k<keys;k++){
+        int out;
+        if(map.find(k,out)){
+            if(out != value_of(k))
+                fail();
+            found++;
+        }
+    }
+    if(found != map.size())
+        fail();
+}
+
+void stress(int keys, int ops){
+    const int threads = 8;
+    sjtu::concurrent_hashmap<int,int> map;
+    std::atomic<long long> balance(0);
+    std::atomic<bool> wrong(false);
+    std::vector<std::thread> workers;
+    for(int t=0;t<threads;t++)
+        workers.emplace_back([&map, &balance, &wrong, t, keys, ops](){
+            unsigned x = 2024 + t*7919;
+            long long mine = 0;
+            for(int i=0;i<ops;i++){
+                x = x*1103515245+12345;
+                int key = int((x>>8)%unsigned(keys));
+                int out;
+                switch((x>>4)%8){
+                case 0: case 1: case 2:
+                    mine += map.insert(sjtu::pair<const int,int>(key,value_of(key)));
+                    break;
+                case 3: case 4:
+                    mine -= map.remove(key);
+                    break;
+                case 5: case 6:
+                    if(map.find(key,out) && out != value_of(key))
+                        wrong = true;
+                    break;
+                default:
+                    if(i%64 == 0)
+                        map.expand();
+                    else
+                        map.visit(key, [&wrong, key](const int &value){
+                            if(value != value_of(key))
+                                wrong = true;
+                        });
+                }
+            }
+            balance += mine;
+        });
+    for(auto &w : workers)
+        w.join();
+    if(wrong || map.size() != size_t(balance.load()))
+        fail();
+    check_all(map, keys);
+}
+
+/**
+ * expand() doubles only while there are fewer than two buckets per
+ * element, so a lookup after many calls still finds a small segment
+ */
+void expand_tester(){
+    const int keys = 1000;
+    sjtu::concurrent_hashmap<int,int> map;
+    for(int k=0;k<keys;k++)
+        map.insert(sjtu::pair<const int,int>(k,value_of(k)));
+    for(int i=0;i<200;i++)
+        map.expand();
+    if(map.buckets() > 4*keys)
+        fail();
+    check_all(map, keys);
+    for(int k=keys;k<2*keys;k++)
+        map.insert(sjtu::pair<const int,int>(k,value_of(k)));
+    check_all(map, 2*keys);
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("13.out","w",stdout);
+#endif
+    std::cout<<c[2];
+    stress(64, 100000);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[3];
+    stress(4096, 100000);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[4];
+    expand_tester();
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[5]<<std::endl;
+}
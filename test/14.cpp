@@ -0,0 +1,206 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <list>
+
+// the policies of policy.hpp that need no more than the order list:
+// lru, fifo and slru, each run against a model built on std::list
+// with random gets and saves, most of them on a hot set smaller than
+// the cache; after every get the hit or miss and the value, and every
+// 500 operations the whole order, have to be the model's. random has
+// no order to compare, only the cache contents are checked.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: lru_policy against a model",
+    "test2: fifo_policy against a model",
+    "test3: slru_policy against a model",
+    "test4: random_policy",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+typedef std::list<int>::iterator position;
+
+/**
+ * lru, or fifo when a hit changes nothing
+ */
+struct queue_model{
+    size_t c;
+    bool hits_move;
+    std::list<int> order;
+    std::unordered_map<int,position> where;
+    queue_model(size_t c, bool hits_move):c(c), hits_move(hits_move){}
+    bool get(int key){
+        auto w = where.find(key);
+        if(w == where.end())
+            return false;
+        if(hits_move)
+            order.splice(order.end(), order, w->second);
+        return true;
+    }
+    void save(int key){
+        if(get(key))
+            return;
+        if(where.size() == c){
+            where.erase(order.front());
+            order.pop_front();
+        }
+        where[key] = order.insert(order.end(), key);
+    }
+    std::vector<int> expected() const {
+        return std::vector<int>(order.begin(), order.end());
+    }
+};
+
+/**
+ * a hit moves a probation key to the end of protected, which holds
+ * c - c / 5 keys at most and hands its oldest back to the end of
+ * probation; the victim is the oldest of probation, of protected if
+ * probation is empty
+ */
+struct slru_model{
+    size_t c;
+    std::list<int> probation, protect;
+    std::unordered_map<int,std::pair<bool,position> > where; // key -> protected, position
+    slru_model(size_t c):c(c){}
+    bool get(int key){
+        auto w = where.find(key);
+        if(w == where.end())
+            return false;
+        if(w->second.first){
+            protect.splice(protect.end(), protect, w->second.second);
+            return true;
+        }
+        protect.splice(protect.end(), probation, w->second.second);
+        w->second.first = true;
+        if(protect.size() > c - c/5){
+            where[protect.front()].first = false;
+            probation.splice(probation.end(), protect, protect.begin());
+        }
+        return true;
+    }
+    void save(int key){
+        if(get(key))
+            return;
+        if(where.size() == c){
+            std::list<int> &from = probation.empty() ? protect : probation;
+            where.erase(from.front());
+            from.pop_front();
+        }
+        where[key] = std::make_pair(false, probation.insert(probation.end(), key));
+    }
+    std::vector<int> expected() const {
+        std::vector<int> keys(probation.begin(), probation.end());
+        keys.insert(keys.end(), protect.begin(), protect.end());
+        return keys;
+    }
+};
+
+/**
+ * ops random gets and saves, three in four on keys [0, hot), the
+ * others on [0, keys); value[key] is what key was last saved with
+ */
+template<class Policy, class Model>
+void model_tester(Model &model, int capacity, int hot, int keys, int ops){
+    using value_type = sjtu::pair<const int,int>;
+    sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,Policy> tester(capacity);
+    std::unordered_map<int,int> value;
+    unsigned x = 2024;
+    for(int r=1;r<=ops;r++){
+        x = x*1103515245+12345;
+        int key = int((x>>8)%unsigned((x>>4)%4 ? hot : keys));
+        x = x*1103515245+12345;
+        if((x>>8)%2){
+            int *got = tester.get(key);
+            if((got != nullptr) != model.get(key))
+                fail();
+            if(got && *got != value[key])
+                fail();
+        }else{
+            tester.save(value_type(key,r));
+            model.save(key);
+            value[key] = r;
+        }
+        if(r%500 == 0){
+            std::vector<int> expected = model.expected();
+            if(tester.map.size() != expected.size())
+                fail();
+            size_t i = 0;
+            for(auto it = tester.map.begin();it!=tester.map.end();it++,i++)
+                if((*it).first != expected[i] || (*it).second != value[expected[i]])
+                    fail();
+        }
+    }
+}
+
+/**
+ * the cache is full once c keys came in, holds only keys with their
+ * last values, and a key saved is there right after
+ */
+void random_tester(){
+    using value_type = sjtu::pair<const int,int>;
+    const int capacity = 64, keys = 512;
+    sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::random_policy> tester(capacity);
+    std::unordered_map<int,int> value;
+    unsigned x = 7;
+    for(int r=1;r<=40000;r++){
+        x = x*1103515245+12345;
+        int key = int((x>>8)%unsigned(keys));
+        if((x>>4)%2){
+            int *got = tester.get(key);
+            if(got && *got != value[key])
+                fail();
+        }else{
+            tester.save(value_type(key,r));
+            value[key] = r;
+            int *got = tester.get(key);
+            if(!got || *got != r)
+                fail();
+        }
+        if(tester.map.size() > size_t(capacity) || (value.size() >= size_t(capacity) && tester.map.size() != size_t(capacity)))
+            fail();
+    }
+    for(auto it = tester.map.begin();it!=tester.map.end();it++)
+        if((*it).second != value[(*it).first])
+            fail();
+    tester.clear();
+    for(int k=0;k<2*capacity;k++)
+        tester.save(value_type(k,k));
+    if(tester.map.size() != size_t(capacity))
+        fail();
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("14.out","w",stdout);
+#endif
+    std::cout<<c[2];
+    queue_model lru(64, true);
+    model_tester<sjtu::lru_policy>(lru, 64, 48, 512, 60000);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[3];
+    queue_model fifo(64, false);
+    model_tester<sjtu::fifo_policy>(fifo, 64, 48, 512, 60000);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[4];
+    slru_model slru(64);
+    model_tester<sjtu::slru_policy>(slru, 64, 48, 512, 60000);
+    slru_model small(3);
+    model_tester<sjtu::slru_policy>(small, 3, 4, 16, 20000);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[5];
+    random_tester();
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[6]<<std::endl;
+}
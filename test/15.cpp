@@ -0,0 +1,219 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <list>
+
+// tinylfu_policy: the frequency_sketch on its own, then the cache
+// against a model of W-TinyLFU built on std::list with a sketch of
+// its own fed the same hashes, so every admission decision has to
+// come out the same; after every get the hit or miss, and every 500
+// operations the whole order [probation | protected | window], have
+// to be the model's. last, a scan of keys seen once must not push
+// out a hot set.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: frequency_sketch",
+    "test2: tinylfu_policy against a model",
+    "test3: tinylfu_policy under a scan",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+/**
+ * within a period no estimate is below the true count (16 at most)
+ * and few are above it; a period later, the counts are halved
+ */
+void sketch_tester(){
+    const size_t n = 1024;
+    std::cout<<c[2];
+    sjtu::frequency_sketch sketch;
+    sketch.ensure_capacity(n);
+    std::hash<int> hash;
+    unsigned over = 0;
+    for(int k=0;k<200;k++)
+        for(int i=0;i<k%20;i++)
+            sketch.increment(hash(k));
+    for(int k=0;k<200;k++){
+        unsigned expected = k%20 < 16 ? k%20 : 16;
+        unsigned got = sketch.frequency(hash(k));
+        if(got < expected)
+            fail();
+        over += got - expected;
+    }
+    if(over > 20)
+        fail();
+    // sample_size is 10 * n: the next period starts before this ends
+    for(int k=0;k<int(10*n);k++)
+        sketch.increment(hash(1000+k));
+    if(sketch.frequency(hash(19)) > 8)
+        fail();
+    sketch.clear();
+    if(sketch.frequency(hash(19)) != 0)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+typedef std::list<int>::iterator position;
+
+/**
+ * new keys go to the end of the window (1% of c, at least 1); its
+ * oldest goes on to the end of probation while main has room, else
+ * only if the sketch saw it more often than main's victim, the oldest
+ * of probation (of protected if that is empty). main is an slru whose
+ * protected part holds 80% of it.
+ */
+struct tinylfu_model{
+    enum { probation, protect, window };
+    size_t c, window_capacity, protected_capacity;
+    std::list<int> lists[3];
+    std::unordered_map<int,std::pair<int,position> > where;
+    sjtu::frequency_sketch sketch;
+    std::hash<int> hash;
+    tinylfu_model(size_t c):c(c){
+        window_capacity = c/100 ? c/100 : 1;
+        size_t main = c - window_capacity;
+        protected_capacity = main - main/5;
+        sketch.ensure_capacity(c);
+    }
+    void move(int key, int to){
+        std::pair<int,position> &w = where[key];
+        lists[to].splice(lists[to].end(), lists[w.first], w.second);
+        w.first = to;
+    }
+    void admit(){
+        move(lists[window].front(), probation);
+    }
+    bool get(int key){
+        sketch.increment(hash(key));
+        auto w = where.find(key);
+        if(w == where.end())
+            return false;
+        if(w->second.first != probation){
+            move(key, w->second.first);
+            return true;
+        }
+        move(key, protect);
+        if(lists[protect].size() > protected_capacity)
+            move(lists[protect].front(), probation);
+        return true;
+    }
+    int victim(){
+        int first = !lists[probation].empty() ? lists[probation].front()
+            : !lists[protect].empty() ? lists[protect].front() : lists[window].front();
+        if(lists[window].size() < window_capacity || where[first].first == window)
+            return first;
+        int candidate = lists[window].front();
+        if(sketch.frequency(hash(candidate)) <= sketch.frequency(hash(first)))
+            return candidate;
+        admit();
+        return first;
+    }
+    void save(int key){
+        if(where.count(key)){
+            get(key);
+            return;
+        }
+        if(where.size() == c){
+            int v = victim();
+            lists[where[v].first].erase(where[v].second);
+            where.erase(v);
+        }
+        sketch.increment(hash(key));
+        where[key] = std::make_pair(int(window), lists[window].insert(lists[window].end(), key));
+        if(lists[window].size() > window_capacity)
+            admit();
+    }
+    std::vector<int> expected() const {
+        std::vector<int> keys;
+        for(int l=0;l<3;l++)
+            keys.insert(keys.end(), lists[l].begin(), lists[l].end());
+        return keys;
+    }
+};
+
+/**
+ * ops random gets and saves, three in four on keys [0, hot), the
+ * others on [0, keys); value[key] is what key was last saved with
+ */
+void model_tester(int capacity, int hot, int keys, int ops){
+    using value_type = sjtu::pair<const int,int>;
+    sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::tinylfu_policy> tester(capacity);
+    tinylfu_model model(capacity);
+    std::unordered_map<int,int> value;
+    unsigned x = 2024;
+    for(int r=1;r<=ops;r++){
+        x = x*1103515245+12345;
+        int key = int((x>>8)%unsigned((x>>4)%4 ? hot : keys));
+        x = x*1103515245+12345;
+        if((x>>8)%2){
+            int *got = tester.get(key);
+            if((got != nullptr) != model.get(key))
+                fail();
+            if(got && *got != value[key])
+                fail();
+        }else{
+            tester.save(value_type(key,r));
+            model.save(key);
+            value[key] = r;
+        }
+        if(r%500 == 0){
+            std::vector<int> expected = model.expected();
+            if(tester.map.size() != expected.size())
+                fail();
+            size_t i = 0;
+            for(auto it = tester.map.begin();it!=tester.map.end();it++,i++)
+                if((*it).first != expected[i] || (*it).second != value[expected[i]])
+                    fail();
+        }
+    }
+}
+
+/**
+ * a hot set of half the capacity, used a few times each, then ten
+ * times the capacity of new keys saved once: nine in ten hot keys
+ * have to be left
+ */
+void scan_tester(){
+    using value_type = sjtu::pair<const int,int>;
+    const int capacity = 1000, hot = 500;
+    std::cout<<c[4];
+    sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::tinylfu_policy> tester(capacity);
+    for(int k=0;k<hot;k++)
+        tester.save(value_type(k,k));
+    for(int round=0;round<4;round++)
+        for(int k=0;k<hot;k++)
+            if(!tester.get(k))
+                fail();
+    for(int k=hot;k<hot+10*capacity;k++)
+        tester.save(value_type(k,k));
+    int left = 0;
+    for(int k=0;k<hot;k++)
+        left += tester.get(k) != nullptr;
+    if(left < hot*9/10)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("15.out","w",stdout);
+#endif
+    sketch_tester();
+    std::cout<<c[3];
+    model_tester(200, 150, 2000, 60000);
+    model_tester(5, 6, 40, 20000);
+    std::cout<<c[0]<<std::endl;
+    scan_tester();
+    std::cout<<c[5]<<std::endl;
+}
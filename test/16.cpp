@@ -0,0 +1,184 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <list>
+
+// arc_policy against ARC as Megiddo and Modha give it, on four
+// std::list: random gets and saves on a hot set a bit larger than the
+// cache, so that keys keep coming back from both ghost lists; after
+// every get the hit or miss, and every 500 operations the whole order
+// [T1 | T2], have to be the model's. the ghost lists and p can't be
+// seen from outside, a mistake in them shows as a different victim
+// later on.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: arc_policy against a model",
+    "test2: arc_policy with a small capacity",
+    "test3: arc_policy after clear",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+typedef std::list<int>::iterator position;
+
+/**
+ * T1 / T2 the resident keys used once / more than once lately, B1 /
+ * B2 the keys last evicted from them, all oldest first; p the target
+ * size of T1
+ */
+struct arc_model{
+    enum { t1, t2, b1, b2 };
+    size_t c, p;
+    std::list<int> lists[4];
+    std::unordered_map<int,std::pair<int,position> > where;
+    arc_model(size_t c):c(c), p(0){}
+    size_t size(int l) const {
+        return lists[l].size();
+    }
+    void move(int key, int to){
+        std::pair<int,position> &w = where[key];
+        lists[to].splice(lists[to].end(), lists[w.first], w.second);
+        w.first = to;
+    }
+    void drop(int l){
+        where.erase(lists[l].front());
+        lists[l].pop_front();
+    }
+    /**
+     * make room: T1's oldest goes to B1 while T1 is over p, T2's
+     * oldest to B2 otherwise
+     */
+    void replace(bool in_b2){
+        if(size(t1) && (size(t1) > p || (in_b2 && size(t1) == p) || !size(t2)))
+            move(lists[t1].front(), b1);
+        else
+            move(lists[t2].front(), b2);
+    }
+    bool get(int key){
+        auto w = where.find(key);
+        if(w == where.end() || w->second.first == b1 || w->second.first == b2)
+            return false;
+        move(key, t2);
+        return true;
+    }
+    void save(int key){
+        if(get(key))
+            return;
+        auto w = where.find(key);
+        bool full = size(t1) + size(t2) == c;
+        if(w != where.end()){
+            // a ghost: the list it was evicted from was too short
+            if(w->second.first == b1){
+                size_t step = size(b2) > size(b1) ? size(b2) / size(b1) : 1;
+                p = p + step < c ? p + step : c;
+            }else{
+                size_t step = size(b1) > size(b2) ? size(b1) / size(b2) : 1;
+                p = p > step ? p - step : 0;
+            }
+            bool in_b2 = w->second.first == b2;
+            if(full)
+                replace(in_b2);
+            move(key, t2);
+            return;
+        }
+        if(full){
+            if(size(t1) + size(b1) >= c){
+                if(!size(b1)){
+                    drop(t1);
+                }else{
+                    drop(b1);
+                    replace(false);
+                }
+            }else{
+                if(size(t1) + size(t2) + size(b1) + size(b2) >= 2*c && size(b2))
+                    drop(b2);
+                replace(false);
+            }
+        }
+        where[key] = std::make_pair(int(t1), lists[t1].insert(lists[t1].end(), key));
+    }
+    std::vector<int> expected() const {
+        std::vector<int> keys(lists[t1].begin(), lists[t1].end());
+        keys.insert(keys.end(), lists[t2].begin(), lists[t2].end());
+        return keys;
+    }
+};
+
+typedef sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::arc_policy> arc_lru;
+
+/**
+ * ops random gets and saves, three in four on keys [0, hot), the
+ * others on [0, keys); value[key] is what key was last saved with
+ */
+void model_tester(arc_lru &tester, arc_model &model, int hot, int keys, int ops, unsigned seed){
+    using value_type = sjtu::pair<const int,int>;
+    std::unordered_map<int,int> value;
+    unsigned x = seed;
+    for(int r=1;r<=ops;r++){
+        x = x*1103515245+12345;
+        int key = int((x>>8)%unsigned((x>>4)%4 ? hot : keys));
+        x = x*1103515245+12345;
+        if((x>>8)%2){
+            int *got = tester.get(key);
+            if((got != nullptr) != model.get(key))
+                fail();
+            if(got && *got != value[key])
+                fail();
+        }else{
+            tester.save(value_type(key,r));
+            model.save(key);
+            value[key] = r;
+        }
+        if(r%500 == 0){
+            std::vector<int> expected = model.expected();
+            if(tester.map.size() != expected.size())
+                fail();
+            size_t i = 0;
+            for(auto it = tester.map.begin();it!=tester.map.end();it++,i++)
+                if((*it).first != expected[i] || (*it).second != value[expected[i]])
+                    fail();
+        }
+    }
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("16.out","w",stdout);
+#endif
+    std::cout<<c[2];
+    {
+        arc_lru tester(64);
+        arc_model model(64);
+        model_tester(tester, model, 96, 512, 100000, 2024);
+    }
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[3];
+    for(int capacity=1;capacity<=8;capacity++){
+        arc_lru tester(capacity);
+        arc_model model(capacity);
+        model_tester(tester, model, capacity+capacity/2+1, 4*capacity+4, 20000, 7*capacity);
+    }
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[4];
+    {
+        arc_lru tester(32);
+        arc_model model(32);
+        model_tester(tester, model, 48, 256, 20000, 1);
+        tester.clear();
+        arc_model fresh(32);
+        model_tester(tester, fresh, 48, 256, 20000, 2);
+    }
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[5]<<std::endl;
+}
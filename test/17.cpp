@@ -0,0 +1,290 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <list>
+
+// clock_policy and clock_pro_policy against models on a std::vector
+// of slots: random gets and saves, most of them on a hot set, and
+// after every get the hit or miss, every 500 operations the keys
+// that are in the cache, have to be the model's. the clocks don't
+// reorder the list, so which keys are left is what shows a wrong
+// victim. last, a hot set has to outlive a scan under CLOCK-Pro.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: clock_policy against a model",
+    "test2: clock_pro_policy against a model",
+    "test3: clock_pro_policy under a scan",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+/**
+ * a slot per key, a new key takes the latest slot given up; the hand
+ * clears the reference bits it passes and stops at a clear one
+ */
+struct clock_model{
+    struct slot{
+        int key;
+        bool referenced, vacant;
+    };
+    size_t c, hand;
+    std::vector<slot> slots;
+    std::vector<size_t> free_slots;
+    std::unordered_map<int,size_t> where;
+    clock_model(size_t c):c(c), hand(0){}
+    bool get(int key){
+        auto w = where.find(key);
+        if(w == where.end())
+            return false;
+        slots[w->second].referenced = true;
+        return true;
+    }
+    void save(int key){
+        if(get(key))
+            return;
+        if(where.size() == c){
+            while(true){
+                if(hand >= slots.size())
+                    hand = 0;
+                slot &s = slots[hand];
+                if(!s.vacant && !s.referenced)
+                    break;
+                s.referenced = false;
+                hand++;
+            }
+            where.erase(slots[hand].key);
+            slots[hand].vacant = true;
+            free_slots.push_back(hand++);
+        }
+        slot s = {key, false, false};
+        if(free_slots.empty()){
+            where[key] = slots.size();
+            slots.push_back(s);
+        }else{
+            where[key] = free_slots.back();
+            slots[free_slots.back()] = s;
+            free_slots.pop_back();
+        }
+    }
+};
+
+/**
+ * the slots of clock_model with a status each: a new key is cold and
+ * in its test period, and hot if it still had a test entry; the cold
+ * hand evicts unreferenced cold keys, makes referenced ones in test
+ * hot and starts a new test for the others; the hot hand turns
+ * unreferenced hot keys cold and ends the tests it passes. a reuse in
+ * a test period moves cold_target up, a test that ran out down.
+ */
+struct clock_pro_model{
+    enum { cold, cold_in_test, hot, vacant };
+    struct slot{
+        int key;
+        bool referenced;
+        int status;
+    };
+    size_t c, hand_cold, hand_hot, hot_count, cold_target;
+    std::vector<slot> slots;
+    std::vector<size_t> free_slots;
+    std::unordered_map<int,size_t> where;
+    std::list<int> tests; // oldest first
+    clock_pro_model(size_t c):c(c), hand_cold(0), hand_hot(0), hot_count(0), cold_target(0){}
+    size_t cold_capacity() const {
+        return cold_target > c/10+1 ? cold_target : c/10+1;
+    }
+    size_t hot_capacity() const {
+        return c > cold_capacity() ? c - cold_capacity() : 0;
+    }
+    void reused(){
+        cold_target = cold_capacity() < c ? cold_capacity() + 1 : c;
+    }
+    void expired(){
+        if(cold_target > c/10+1)
+            cold_target--;
+    }
+    void make_hot(slot &s){
+        s.status = hot;
+        hot_count++;
+        reused();
+        while(hot_count > hot_capacity())
+            run_hot_hand();
+    }
+    void run_hot_hand(){
+        while(true){
+            if(hand_hot >= slots.size())
+                hand_hot = 0;
+            slot &s = slots[hand_hot++];
+            if(s.status == hot){
+                if(!s.referenced){
+                    s.status = cold;
+                    hot_count--;
+                    return;
+                }
+                s.referenced = false;
+            }else if(s.status == cold_in_test && !s.referenced){
+                s.status = cold;
+                expired();
+            }
+        }
+    }
+    bool get(int key){
+        auto w = where.find(key);
+        if(w == where.end())
+            return false;
+        slots[w->second].referenced = true;
+        return true;
+    }
+    void evict(){
+        if(hot_count == where.size())
+            run_hot_hand();
+        while(true){
+            if(hand_cold >= slots.size())
+                hand_cold = 0;
+            slot &s = slots[hand_cold];
+            if(s.status == cold || s.status == cold_in_test){
+                if(!s.referenced)
+                    break;
+                s.referenced = false;
+                if(s.status == cold)
+                    s.status = cold_in_test;
+                else
+                    make_hot(s);
+            }
+            hand_cold++;
+        }
+        slot &s = slots[hand_cold];
+        where.erase(s.key);
+        if(s.status == cold_in_test){
+            tests.push_back(s.key);
+            if(tests.size() > c){
+                tests.pop_front();
+                expired();
+            }
+        }
+        s.status = vacant;
+        free_slots.push_back(hand_cold++);
+    }
+    void save(int key){
+        if(get(key))
+            return;
+        if(where.size() == c)
+            evict();
+        slot s = {key, false, cold_in_test};
+        size_t i = slots.size();
+        if(free_slots.empty())
+            slots.push_back(s);
+        else{
+            i = free_slots.back();
+            slots[i] = s;
+            free_slots.pop_back();
+        }
+        where[key] = i;
+        for(std::list<int>::iterator t = tests.begin();t!=tests.end();t++)
+            if(*t == key){
+                tests.erase(t);
+                make_hot(slots[i]);
+                break;
+            }
+    }
+};
+
+/**
+ * ops random gets and saves, three in four on keys [0, hot), the
+ * others on [0, keys); value[key] is what key was last saved with
+ */
+template<class Policy, class Model>
+void model_tester(Model &model, int capacity, int hot, int keys, int ops){
+    using value_type = sjtu::pair<const int,int>;
+    sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,Policy> tester(capacity);
+    std::unordered_map<int,int> value;
+    unsigned x = 2024;
+    for(int r=1;r<=ops;r++){
+        x = x*1103515245+12345;
+        int key = int((x>>8)%unsigned((x>>4)%4 ? hot : keys));
+        x = x*1103515245+12345;
+        if((x>>8)%2){
+            int *got = tester.get(key);
+            if((got != nullptr) != model.get(key))
+                fail();
+            if(got && *got != value[key])
+                fail();
+        }else{
+            tester.save(value_type(key,r));
+            model.save(key);
+            value[key] = r;
+        }
+        if(r%500 == 0){
+            if(tester.map.size() != model.where.size())
+                fail();
+            for(auto it = tester.map.begin();it!=tester.map.end();it++)
+                if(!model.where.count((*it).first) || (*it).second != value[(*it).first])
+                    fail();
+        }
+    }
+}
+
+/**
+ * four rounds over a hot set of half the capacity, each hot key
+ * followed by two keys seen once, so the hot keys come back from
+ * their test entries hot; then a scan of ten times the capacity with
+ * a few hot keys read now and then. nine in ten hot keys have to be
+ * left (clock_policy and lru_policy keep about one in a hundred)
+ */
+void scan_tester(){
+    using value_type = sjtu::pair<const int,int>;
+    const int capacity = 1000, hot = 500;
+    std::cout<<c[4];
+    sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::clock_pro_policy> tester(capacity);
+    int once = -1;
+    for(int round=0;round<4;round++)
+        for(int k=0;k<hot;k++){
+            tester.save(value_type(k,k));
+            tester.save(value_type(once--,0));
+            tester.save(value_type(once--,0));
+        }
+    for(int k=hot;k<hot+10*capacity;k++){
+        tester.save(value_type(k,k));
+        if(k%4 == 0)
+            for(int j=0;j<hot;j+=50)
+                tester.get(j);
+    }
+    int left = 0;
+    for(int k=0;k<hot;k++)
+        left += tester.get(k) != nullptr;
+    if(left < hot*9/10)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("17.out","w",stdout);
+#endif
+    std::cout<<c[2];
+    clock_model clock(64);
+    model_tester<sjtu::clock_policy>(clock, 64, 48, 512, 60000);
+    clock_model small_clock(3);
+    model_tester<sjtu::clock_policy>(small_clock, 3, 4, 16, 20000);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[3];
+    clock_pro_model clock_pro(64);
+    model_tester<sjtu::clock_pro_policy>(clock_pro, 64, 80, 512, 100000);
+    for(int capacity=1;capacity<=8;capacity++){
+        clock_pro_model small(capacity);
+        model_tester<sjtu::clock_pro_policy>(small, capacity, capacity+2, 4*capacity+4, 20000);
+    }
+    std::cout<<c[0]<<std::endl;
+    scan_tester();
+    std::cout<<c[5]<<std::endl;
+}
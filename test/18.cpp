@@ -0,0 +1,170 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <deque>
+#include <algorithm>
+
+// s3fifo_policy against S3-FIFO on three std::deque: random gets and
+// saves on a hot set a bit larger than the cache, so that keys keep
+// coming back through the ghost queue; after every get the hit or
+// miss, and every 500 operations the whole order [S | M], have to be
+// the model's. the ghost queue can't be seen from outside, a mistake
+// in it shows as a key going to the wrong queue later on.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: s3fifo_policy against a model",
+    "test2: s3fifo_policy with a small capacity",
+    "test3: s3fifo_policy after clear",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+/**
+ * S, M and G oldest first, and a counter of 0-3 per resident key:
+ * a hit bumps the counter, a new key goes to S, or to M if it is in
+ * G. S is evicted from while it holds a tenth of c (at least 1) or M
+ * is empty: its oldest moves on to M if the counter is set, otherwise
+ * goes, into G. M's oldest goes if its counter is 0, otherwise it is
+ * put back at the end with the counter one lower. G keeps the last
+ * c - c / 10 keys.
+ */
+struct s3fifo_model{
+    size_t c;
+    std::deque<int> small, main, ghost;
+    std::unordered_map<int,int> frequency;
+    s3fifo_model(size_t c):c(c){}
+    bool get(int key){
+        auto f = frequency.find(key);
+        if(f == frequency.end())
+            return false;
+        if(f->second < 3)
+            f->second++;
+        return true;
+    }
+    void evict(){
+        while(true){
+            if(!small.empty() && (small.size() >= (c/10 ? c/10 : 1) || main.empty())){
+                int key = small.front();
+                small.pop_front();
+                if(frequency[key]){
+                    frequency[key] = 0;
+                    main.push_back(key);
+                    continue;
+                }
+                frequency.erase(key);
+                ghost.push_back(key);
+                if(ghost.size() > c - c/10)
+                    ghost.pop_front();
+                return;
+            }
+            int key = main.front();
+            if(!frequency[key]){
+                main.pop_front();
+                frequency.erase(key);
+                return;
+            }
+            frequency[key]--;
+            if(main.size() > 1){
+                main.pop_front();
+                main.push_back(key);
+            }
+        }
+    }
+    void save(int key){
+        if(get(key))
+            return;
+        if(frequency.size() == c)
+            evict();
+        frequency[key] = 0;
+        std::deque<int>::iterator g = std::find(ghost.begin(), ghost.end(), key);
+        if(g != ghost.end()){
+            ghost.erase(g);
+            main.push_back(key);
+        }else
+            small.push_back(key);
+    }
+    std::vector<int> expected() const {
+        std::vector<int> keys(small.begin(), small.end());
+        keys.insert(keys.end(), main.begin(), main.end());
+        return keys;
+    }
+};
+
+typedef sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::s3fifo_policy> s3fifo_lru;
+
+/**
+ * ops random gets and saves, three in four on keys [0, hot), the
+ * others on [0, keys); value[key] is what key was last saved with
+ */
+void model_tester(s3fifo_lru &tester, s3fifo_model &model, int hot, int keys, int ops, unsigned seed){
+    using value_type = sjtu::pair<const int,int>;
+    std::unordered_map<int,int> value;
+    unsigned x = seed;
+    for(int r=1;r<=ops;r++){
+        x = x*1103515245+12345;
+        int key = int((x>>8)%unsigned((x>>4)%4 ? hot : keys));
+        x = x*1103515245+12345;
+        if((x>>8)%2){
+            int *got = tester.get(key);
+            if((got != nullptr) != model.get(key))
+                fail();
+            if(got && *got != value[key])
+                fail();
+        }else{
+            tester.save(value_type(key,r));
+            model.save(key);
+            value[key] = r;
+        }
+        if(r%500 == 0){
+            std::vector<int> expected = model.expected();
+            if(tester.map.size() != expected.size())
+                fail();
+            size_t i = 0;
+            for(auto it = tester.map.begin();it!=tester.map.end();it++,i++)
+                if((*it).first != expected[i] || (*it).second != value[expected[i]])
+                    fail();
+        }
+    }
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("18.out","w",stdout);
+#endif
+    std::cout<<c[2];
+    {
+        s3fifo_lru tester(100);
+        s3fifo_model model(100);
+        model_tester(tester, model, 150, 1000, 100000, 2024);
+    }
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[3];
+    for(int capacity=1;capacity<=12;capacity++){
+        s3fifo_lru tester(capacity);
+        s3fifo_model model(capacity);
+        model_tester(tester, model, capacity+capacity/2+1, 4*capacity+4, 20000, 7*capacity);
+    }
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[4];
+    {
+        s3fifo_lru tester(40);
+        s3fifo_model model(40);
+        model_tester(tester, model, 60, 400, 20000, 1);
+        tester.clear();
+        s3fifo_model fresh(40);
+        model_tester(tester, fresh, 60, 400, 20000, 2);
+    }
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[5]<<std::endl;
+}
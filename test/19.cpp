@@ -0,0 +1,313 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <list>
+#include <stdexcept>
+
+// weighted capacity: an element weighs the length of its string, and
+// random gets and saves of random lengths (now and then one longer
+// than c, which goes in alone) are run through lru and fifo against
+// a std::list model, with c lowered half way; every 500 operations
+// the order, the values and the weight have to be the model's. saves
+// that make an element heavier evict until the weights fit again,
+// the element itself too if fifo picks it while others are left; an
+// update heavier than c stays, alone, and an update whose assignment
+// throws leaves the weight as it was. then gdsf_policy: the
+// elements a save evicts must be the ones with the lowest priority
+// L + frequency / weight as a model of every element's priority has
+// it, and L must then be that of the last one.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: lru_policy with weights against a model",
+    "test2: fifo_policy with weights against a model",
+    "test3: gdsf_policy priorities",
+    "test4: gdsf_policy keeps small, often used elements",
+    "test5: an update heavier than c stays, alone",
+    "test6: an update that throws",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+struct length_weigher{
+    size_t operator()(int, const std::string &value) const {
+        return value.size();
+    }
+};
+
+typedef std::list<int>::iterator position;
+
+/**
+ * lru, or fifo when a hit changes nothing; the oldest goes until the
+ * weights fit
+ */
+struct weighted_model{
+    size_t c, weight;
+    bool hits_move;
+    std::list<int> order;
+    std::unordered_map<int,std::pair<std::string,position> > where;
+    weighted_model(size_t c, bool hits_move):c(c), weight(0), hits_move(hits_move){}
+    bool get(int key){
+        auto w = where.find(key);
+        if(w == where.end())
+            return false;
+        if(hits_move)
+            order.splice(order.end(), order, w->second.second);
+        return true;
+    }
+    void evict(){
+        weight -= where[order.front()].first.size();
+        where.erase(order.front());
+        order.pop_front();
+    }
+    void save(int key, const std::string &value){
+        if(get(key)){
+            weight += value.size() - where[key].first.size();
+            where[key].first = value;
+            while(weight > c && !(order.size() == 1 && order.front() == key))
+                evict();
+            return;
+        }
+        while(weight + value.size() > c && !order.empty())
+            evict();
+        weight += value.size();
+        where[key] = std::make_pair(value, order.insert(order.end(), key));
+    }
+};
+
+/**
+ * a string of 1 to 40 characters, one in fifty of 500
+ */
+std::string random_value(unsigned &x){
+    x = x*1103515245+12345;
+    size_t length = (x>>8)%50 == 0 ? 500 : 1+(x>>12)%40;
+    return std::string(length, char('a'+(x>>20)%26));
+}
+
+template<class Policy>
+void weighted_tester(bool hits_move){
+    const int capacity = 400, hot = 30, keys = 200, ops = 40000;
+    sjtu::basic_lru<int,std::string,std::hash<int>,std::equal_to<int>,sjtu::chained_table,Policy,length_weigher> tester(capacity);
+    weighted_model model(capacity, hits_move);
+    unsigned x = 2024;
+    for(int r=1;r<=ops;r++){
+        if(r == ops/2)
+            tester.c = model.c = capacity/2;
+        x = x*1103515245+12345;
+        int key = int((x>>8)%unsigned((x>>4)%4 ? hot : keys));
+        x = x*1103515245+12345;
+        if((x>>8)%2){
+            std::string *got = tester.get(key);
+            if((got != nullptr) != model.get(key))
+                fail();
+            if(got && *got != model.where[key].first)
+                fail();
+        }else{
+            std::string value = random_value(x);
+            tester.save(sjtu::pair<const int,std::string>(key,value));
+            model.save(key, value);
+            if(tester.weight > tester.c && tester.map.size() > 1)
+                fail();
+        }
+        if(r%500 == 0){
+            if(tester.map.size() != model.order.size() || tester.weight != model.weight)
+                fail();
+            position oit = model.order.begin();
+            for(auto it = tester.map.begin();it!=tester.map.end();it++,oit++)
+                if((*it).first != *oit || (*it).second != model.where[*oit].first)
+                    fail();
+        }
+    }
+}
+
+/**
+ * the frequency and the priority every resident key has after each
+ * save as gdsf_policy would give them; the keys a save took out are
+ * found by looking at what is left in the cache
+ */
+struct gdsf_model{
+    double inflation;
+    std::unordered_map<int,std::pair<size_t,double> > where; // key -> frequency, priority
+    gdsf_model():inflation(0){}
+    void use(int key, size_t weight){
+        std::pair<size_t,double> &e = where[key];
+        e.first++;
+        e.second = inflation + double(e.first) / double(weight ? weight : 1);
+    }
+};
+
+void gdsf_tester(){
+    const int capacity = 400, hot = 30, keys = 200, ops = 40000;
+    const double eps = 1e-9;
+    std::cout<<c[4];
+    sjtu::basic_lru<int,std::string,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::gdsf_policy,length_weigher> tester(capacity);
+    gdsf_model model;
+    size_t evicted = 0;
+    unsigned x = 7;
+    for(int r=1;r<=ops;r++){
+        if(r == ops/2)
+            tester.c = capacity/2;
+        x = x*1103515245+12345;
+        int key = int((x>>8)%unsigned((x>>4)%4 ? hot : keys));
+        x = x*1103515245+12345;
+        if((x>>8)%2){
+            std::string *got = tester.get(key);
+            if((got != nullptr) != (model.where.count(key) == 1))
+                fail();
+            if(got)
+                model.use(key, got->size());
+            continue;
+        }
+        std::string value = random_value(x);
+        bool update = model.where.count(key) == 1;
+        if(update)
+            model.use(key, value.size());
+        tester.save(sjtu::pair<const int,std::string>(key,value));
+        double highest_gone = -1, lowest_left = 1e300;
+        std::vector<int> gone;
+        for(auto &e : model.where){
+            if(tester.map.find(e.first) == tester.map.end()){
+                gone.push_back(e.first);
+                highest_gone = e.second.second > highest_gone ? e.second.second : highest_gone;
+            }else if(e.first != key || update)
+                lowest_left = e.second.second < lowest_left ? e.second.second : lowest_left;
+        }
+        if(highest_gone > lowest_left + eps)
+            fail();
+        for(size_t i=0;i<gone.size();i++)
+            model.where.erase(gone[i]);
+        evicted += gone.size();
+        if(!gone.empty())
+            model.inflation = highest_gone;
+        if(!update)
+            model.use(key, value.size());
+        if(model.where.size() != tester.map.size())
+            fail();
+        if(tester.weight > tester.c && tester.map.size() > 1)
+            fail();
+    }
+    if(evicted < size_t(ops)/10)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+/**
+ * small elements read over and over next to big ones saved once: the
+ * big ones have to be the ones that go
+ */
+void gdsf_size_tester(){
+    const int capacity = 1000, small = 50;
+    std::cout<<c[5];
+    sjtu::basic_lru<int,std::string,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::gdsf_policy,length_weigher> tester(capacity);
+    for(int k=0;k<small;k++)
+        tester.save(sjtu::pair<const int,std::string>(k,std::string(4,'s')));
+    for(int big=small;big<small+200;big++){
+        tester.save(sjtu::pair<const int,std::string>(big,std::string(100,'b')));
+        for(int k=big%5;k<small;k+=5)
+            if(!tester.get(k))
+                fail();
+    }
+    for(int k=0;k<small;k++)
+        if(!tester.get(k))
+            fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+/**
+ * the updated element, heavier than c, goes in first or last: the
+ * others go, it stays
+ */
+template<class Policy>
+void oversize_update_tester(){
+    using value_type = sjtu::pair<const int,std::string>;
+    for(int updated=0;updated<5;updated+=4){
+        sjtu::basic_lru<int,std::string,std::hash<int>,std::equal_to<int>,sjtu::chained_table,Policy,length_weigher> tester(100);
+        for(int k=0;k<5;k++)
+            tester.save(value_type(k,std::string(10,'a')));
+        tester.save(value_type(updated,std::string(150,'b')));
+        if(tester.map.size() != 1 || tester.weight != 150)
+            fail();
+        std::string *got = tester.get(updated);
+        if(!got || got->size() != 150)
+            fail();
+        // and lighter again, with room for others
+        tester.save(value_type(updated,std::string(10,'c')));
+        tester.save(value_type(9,std::string(10,'c')));
+        if(tester.map.size() != 2 || tester.weight != 20)
+            fail();
+    }
+}
+
+/**
+ * a value whose assignment throws when asked to
+ */
+struct fragile{
+    static bool fail_next;
+    size_t size;
+    fragile(size_t size):size(size){}
+    fragile(const fragile &) = default;
+    fragile & operator=(const fragile &other){
+        if(fail_next){
+            fail_next = false;
+            throw std::runtime_error("fragile");
+        }
+        size = other.size;
+        return *this;
+    }
+};
+bool fragile::fail_next = false;
+
+struct fragile_weigher{
+    size_t operator()(int, const fragile &value) const {
+        return value.size;
+    }
+};
+
+void throwing_update_tester(){
+    using value_type = sjtu::pair<const int,fragile>;
+    std::cout<<c[7];
+    sjtu::basic_lru<int,fragile,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::lru_policy,fragile_weigher> tester(100);
+    for(int k=0;k<5;k++)
+        tester.save(value_type(k,fragile(10)));
+    fragile::fail_next = true;
+    try{
+        tester.save(value_type(2,fragile(60)));
+        fail();
+    }catch(std::runtime_error &){}
+    if(tester.weight != 50 || tester.map.size() != 5 || tester.get(2)->size != 10)
+        fail();
+    tester.save(value_type(2,fragile(60)));
+    if(tester.weight != 100 || tester.map.size() != 5)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("19.out","w",stdout);
+#endif
+    std::cout<<c[2];
+    weighted_tester<sjtu::lru_policy>(true);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[3];
+    weighted_tester<sjtu::fifo_policy>(false);
+    std::cout<<c[0]<<std::endl;
+    gdsf_tester();
+    gdsf_size_tester();
+    std::cout<<c[6];
+    oversize_update_tester<sjtu::lru_policy>();
+    oversize_update_tester<sjtu::fifo_policy>();
+    std::cout<<c[0]<<std::endl;
+    throwing_update_tester();
+    std::cout<<c[8]<<std::endl;
+}
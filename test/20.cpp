@@ -0,0 +1,243 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include "expiring_lru.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+
+// expiring_lru on a manual_clock: a get of an expired key, saving a
+// key again with and without a ttl, how much one save reclaims,
+// deadlines right before, at and after the 64^l tick boundaries of
+// the timing wheel's levels (and past its 64^4 ticks), and last
+// random saves, gets and jumps of the clock over all those ranges,
+// with the exact count of every expire() checked against a model.
+// a save that throws must not leave its ttl behind for the next one.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: get of an expired key",
+    "test2: saving again sets the ttl anew",
+    "test3: a save reclaims reclaim_batch at most",
+    "test4: deadlines at the levels of the wheel",
+    "test5: expire() against a model",
+    "test6: a save that throws",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+typedef sjtu::expiring_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::lru_policy,sjtu::unit_weigher,sjtu::manual_clock> cache;
+typedef sjtu::pair<const int,int> value_type;
+typedef std::chrono::milliseconds ms;
+
+void expired_get_tester(){
+    std::cout<<c[2];
+    cache tester(100);
+    tester.save(value_type(1,10), ms(100));
+    tester.save(value_type(2,20));
+    tester.clock.set(99);
+    if(!tester.get(1) || *tester.get(1) != 10)
+        fail();
+    tester.clock.set(100);
+    if(tester.get(1) || tester.size() != 1)
+        fail();
+    // its timer went with it
+    if(tester.expire() != 0 || !tester.get(2))
+        fail();
+    tester.save(value_type(3,30), ms(0));
+    if(tester.get(3))
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+void resave_tester(){
+    std::cout<<c[3];
+    cache tester(100);
+    tester.save(value_type(1,10), ms(100));
+    tester.clock.set(80);
+    tester.save(value_type(1,11), ms(100));
+    tester.clock.set(179);
+    if(tester.expire() != 0 || !tester.get(1) || *tester.get(1) != 11)
+        fail();
+    tester.clock.set(180);
+    if(tester.get(1))
+        fail();
+
+    tester.save(value_type(2,20), ms(100));
+    tester.save(value_type(2,21));
+    tester.clock.advance(100000000);
+    if(tester.expire() != 0 || !tester.get(2) || *tester.get(2) != 21)
+        fail();
+
+    tester.save(value_type(2,22), ms(50));
+    tester.clock.advance(49);
+    if(tester.expire() != 0)
+        fail();
+    tester.clock.advance(1);
+    if(tester.expire() != 1 || tester.size() != 0)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+void reclaim_tester(){
+    const int n = 100;
+    const size_t batch = cache::reclaim_batch;
+    std::cout<<c[4];
+    cache tester(1000);
+    for(int k=0;k<n;k++)
+        tester.save(value_type(k,k), ms(10));
+    tester.clock.set(20);
+    tester.save(value_type(n,n));
+    if(tester.size() != n-batch+1)
+        fail();
+    tester.save(value_type(n+1,n+1));
+    if(tester.size() != n-2*batch+2)
+        fail();
+    if(tester.expire() != n-2*batch || tester.size() != 2)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+/**
+ * one key per ttl, saved at an odd time so that no deadline starts a
+ * block; at every deadline - 1 nothing is due, at the deadline
+ * exactly the keys with that ttl
+ */
+void level_tester(){
+    const uint64_t start = 12345;
+    std::vector<uint64_t> ttls;
+    for(uint64_t level=64;level<=uint64_t(64)*64*64*64*2;level*=64)
+        for(uint64_t d=level-1;d<=level+1;d++)
+            ttls.push_back(d);
+    ttls.push_back(20000000);
+    ttls.push_back(uint64_t(64)*64*64*64*3+7);
+    std::cout<<c[5];
+    cache tester(1000);
+    tester.clock.set(start);
+    for(size_t i=0;i<ttls.size();i++)
+        tester.save(value_type(int(i),int(i)), ms(ttls[i]));
+    // every deadline twice, one ttl also from a later save
+    tester.save(value_type(-1,-1), ms(ttls[4]));
+    for(size_t i=0;i<ttls.size();i++){
+        tester.clock.set(start+ttls[i]-1);
+        if(tester.expire() != 0 || !tester.get(int(i)))
+            fail();
+        tester.clock.set(start+ttls[i]);
+        if(tester.expire() != (i == 4 ? 2u : 1u) || tester.get(int(i)))
+            fail();
+    }
+    if(tester.size() != 0)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+/**
+ * a ttl of up to 64, 64^2, 64^3 or 2 * 64^4 ms
+ */
+uint64_t random_ttl(unsigned &x){
+    x = x*1103515245+12345;
+    uint64_t range = (x>>8)%4 == 0 ? 64 : (x>>8)%4 == 1 ? 64*64 : (x>>8)%4 == 2 ? 64*64*64 : uint64_t(64)*64*64*64*2;
+    x = x*1103515245+12345;
+    uint64_t r = uint64_t(x>>8)<<20 ^ uint64_t(x*1103515245u+12345u)>>8;
+    return 1+r%range;
+}
+
+void model_tester(){
+    const uint64_t never = uint64_t(-1);
+    const int keys = 3000, rounds = 400;
+    std::cout<<c[6];
+    cache tester(10000);
+    std::unordered_map<int,uint64_t> deadline;
+    unsigned x = 2024;
+    uint64_t now = 0;
+    for(int round=0;round<rounds;round++){
+        // everything due by now was reclaimed last round, so neither
+        // a save nor a get here can find an expired key
+        for(int i=0;i<20;i++){
+            x = x*1103515245+12345;
+            int key = int((x>>8)%unsigned(keys));
+            switch((x>>4)%8){
+            case 0:
+                tester.save(value_type(key,round));
+                deadline[key] = never;
+                break;
+            case 1:
+                if((tester.get(key) != nullptr) != (deadline.count(key) == 1))
+                    fail();
+                break;
+            default:
+                uint64_t ttl = random_ttl(x);
+                tester.save(value_type(key,round), ms(ttl));
+                deadline[key] = now+ttl;
+            }
+        }
+        x = x*1103515245+12345;
+        uint64_t jump = (x>>8)%2 ? 1+(x>>12)%64 : (x>>8)%4 == 0 ? 1+(x>>12)%4096 : 1+(x>>12)%(1u<<22);
+        now += jump;
+        tester.clock.set(now);
+        size_t due = 0;
+        for(auto it = deadline.begin();it!=deadline.end();)
+            if(it->second <= now){
+                due++;
+                it = deadline.erase(it);
+            }else
+                it++;
+        if(tester.expire() != due || tester.size() != deadline.size())
+            fail();
+    }
+    for(int k=0;k<keys;k++)
+        if((tester.get(k) != nullptr) != (deadline.count(k) == 1))
+            fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+/**
+ * weighs 1, and throws for a value of -1
+ */
+struct throwing_weigher{
+    size_t operator()(int, int value) const {
+        if(value == -1)
+            throw std::runtime_error("weigher");
+        return 1;
+    }
+};
+
+void throwing_save_tester(){
+    typedef sjtu::expiring_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::lru_policy,throwing_weigher,sjtu::manual_clock> throwing_cache;
+    std::cout<<c[7];
+    throwing_cache tester(100);
+    try{
+        tester.save(value_type(1,-1), ms(10));
+        fail();
+    }catch(std::runtime_error &){}
+    if(tester.memory.policy.saving || tester.size() != 0)
+        fail();
+    // straight into the cache, not through store: no ttl
+    tester.memory.save(value_type(2,2));
+    tester.clock.set(100);
+    if(tester.expire() != 0 || !tester.get(2))
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("20.out","w",stdout);
+#endif
+    expired_get_tester();
+    resave_tester();
+    reclaim_tester();
+    level_tester();
+    model_tester();
+    throwing_save_tester();
+    std::cout<<c[8]<<std::endl;
+}
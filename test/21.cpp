@@ -0,0 +1,189 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <list>
+
+// hashmap and linked_hashmap on the incremental chained tables, with
+// modulo and mixed hashing: inserts that cross many doublings,
+// interleaved with finds and removes, checked against
+// std::unordered_map. the checks are made while a rehash is half
+// done (old and doubled buckets both in use) as well as between
+// rehashes, and the number of them made mid-rehash is checked too.
+// a copy, an assignment and a clear are also done mid-rehash.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: hashmap, modulo hashing",
+    "test2: hashmap, mixed hashing",
+    "test3: linked_hashmap, modulo hashing",
+    "test4: linked_hashmap, mixed hashing",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+/**
+ * phases of operations on keys [0, keys): two inserts to one remove
+ * while the map grows to keys elements, then as many removes as
+ * inserts; a find of the key before every operation. check(r)
+ * runs every 97 operations
+ */
+template<class Op, class Check>
+void churn(int keys, int ops, Op op, Check check){
+    unsigned x = 2024;
+    for(int r=0;r<ops;r++){
+        x = x*1103515245+12345;
+        int key = int((x>>8)%unsigned(keys));
+        int share = r < ops/2 ? 8 : 6;
+        op(key, int((x>>4)%12) < share, r);
+        if(r%97 == 0)
+            check(r);
+    }
+    check(ops);
+}
+
+template<class Table>
+void hashmap_tester(){
+    using value_type = sjtu::pair<int,int>;
+    using mp = sjtu::hashmap<int,int,std::hash<int>,std::equal_to<int>,Table>;
+    const int keys = 20000, ops = 100000;
+    mp map;
+    std::unordered_map<int,int> ref;
+    int mid_rehash = 0;
+    // every stride-th key from first on
+    auto same = [&](const mp &m, int first, int stride){
+        if(m.size != ref.size())
+            fail();
+        for(int k=first;k<keys;k+=stride){
+            auto it = m.find(k);
+            auto rit = ref.find(k);
+            if((it == m.end()) != (rit == ref.end()))
+                fail();
+            if(rit != ref.end() && (*it).second != rit->second)
+                fail();
+        }
+    };
+    churn(keys, ops, [&](int key, bool insert, int value){
+        auto it = map.find(key);
+        auto rit = ref.find(key);
+        if((it == map.end()) != (rit == ref.end()) || (rit != ref.end() && (*it).second != rit->second))
+            fail();
+        if(insert){
+            bool fresh = map.insert(value_type(key,value)).second;
+            if(fresh != (rit == ref.end()))
+                fail();
+            ref[key] = value;
+        }else if(map.remove(key) != (ref.erase(key) == 1))
+            fail();
+    }, [&](int r){
+        if(map.rehashing())
+            mid_rehash++;
+        same(map, r%7, 7);
+        if(map.rehashing() && r%(97*50) == 0){
+            mp copy(map);
+            same(copy, 0, 1);
+            copy.insert(value_type(-1,-1));
+            map = copy;
+            map.remove(-1);
+            same(map, 0, 1);
+        }
+    });
+    if(mid_rehash < 20)
+        fail();
+    while(!map.rehashing())
+        map.insert(value_type(keys+int(map.size),0));
+    map.clear();
+    ref.clear();
+    same(map, 0, 1);
+    for(int k=0;k<1000;k++){
+        map.insert(value_type(k,k));
+        ref[k] = k;
+    }
+    same(map, 0, 1);
+}
+
+/**
+ * as hashmap_tester, and the order has to be the order of the last
+ * inserts, as a std::list has it
+ */
+template<class Table>
+void linked_hashmap_tester(){
+    using value_type = sjtu::pair<int,int>;
+    using mp = sjtu::linked_hashmap<int,int,std::hash<int>,std::equal_to<int>,Table>;
+    const int keys = 20000, ops = 100000;
+    mp map;
+    std::list<int> order;
+    std::unordered_map<int,std::pair<int,std::list<int>::iterator> > ref;
+    int mid_rehash = 0;
+    auto same = [&](mp &m){
+        if(m.size() != ref.size())
+            fail();
+        std::list<int>::iterator oit = order.begin();
+        for(auto it = m.begin();it!=m.end();it++,oit++)
+            if((*it).first != *oit || (*it).second != ref[*oit].first)
+                fail();
+        for(int k=int(m.size())%7;k<keys;k+=7)
+            if((m.find(k) == m.end()) != (ref.count(k) == 0))
+                fail();
+    };
+    churn(keys, ops, [&](int key, bool insert, int value){
+        auto it = map.find(key);
+        auto rit = ref.find(key);
+        if((it == map.end()) != (rit == ref.end()))
+            fail();
+        if(insert){
+            map.insert(value_type(key,value));
+            if(rit != ref.end()){
+                rit->second.first = value;
+                order.splice(order.end(), order, rit->second.second);
+            }else
+                ref[key] = std::make_pair(value, order.insert(order.end(), key));
+        }else if(rit != ref.end()){
+            map.remove(it);
+            order.erase(rit->second.second);
+            ref.erase(rit);
+        }
+    }, [&](int){
+        if(map.index.rehashing())
+            mid_rehash++;
+        same(map);
+    });
+    if(mid_rehash < 10)
+        fail();
+    while(!map.index.rehashing()){
+        int key = keys+int(map.size());
+        map.insert(value_type(key,0));
+        ref[key] = std::make_pair(0, order.insert(order.end(), key));
+    }
+    map.clear();
+    ref.clear();
+    order.clear();
+    same(map);
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("21.out","w",stdout);
+#endif
+    std::cout<<c[2];
+    hashmap_tester<sjtu::incremental_chained_table>();
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[3];
+    hashmap_tester<sjtu::mixed_incremental_chained_table>();
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[4];
+    linked_hashmap_tester<sjtu::incremental_chained_table>();
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[5];
+    linked_hashmap_tester<sjtu::mixed_incremental_chained_table>();
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[6]<<std::endl;
+}
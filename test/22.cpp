@@ -0,0 +1,195 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+
+// values that count their copies, and values that can't be copied at
+// all, through pair, hashmap, linked_hashmap and lru: an rvalue
+// insert, emplace, try_emplace, insert_or_assign or save, of a new
+// key, of a key already there and of one that evicts another (the
+// victim's node is reused), copies nothing; a save of an lvalue
+// copies once; every value made is destroyed once.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: pair",
+    "test2: hashmap",
+    "test3: linked_hashmap",
+    "test4: lru",
+    "test5: move-only values",
+    "test6: memcheck",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+class counted{
+public:
+    static int copies, moves, live;
+    int value;
+    explicit counted(int value = 0):value(value){ live++; }
+    counted(const counted &other):value(other.value){ copies++; live++; }
+    counted(counted &&other) noexcept :value(other.value){ moves++; live++; }
+    counted & operator=(const counted &other){ value = other.value; copies++; return *this; }
+    counted & operator=(counted &&other) noexcept { value = other.value; moves++; return *this; }
+    ~counted(){ live--; }
+};
+int counted::copies = 0;
+int counted::moves = 0;
+int counted::live = 0;
+
+class move_only{
+public:
+    int value;
+    explicit move_only(int value = 0):value(value){}
+    move_only(const move_only &) = delete;
+    move_only & operator=(const move_only &) = delete;
+    move_only(move_only &&other) noexcept :value(other.value){ other.value = -1; }
+    move_only & operator=(move_only &&other) noexcept { value = other.value; other.value = -1; return *this; }
+};
+
+/**
+ * what ran since the last call copied nothing, and moved at least
+ * once if it had to move
+ */
+void no_copies(bool moved = true){
+    if(counted::copies != 0 || (moved && counted::moves == 0))
+        fail();
+    counted::copies = counted::moves = 0;
+}
+
+void pair_tester(){
+    using value_type = sjtu::pair<const int,counted>;
+    std::cout<<c[2];
+    value_type p(1, counted(5));
+    no_copies();
+    value_type q(std::move(p));
+    no_copies();
+    sjtu::pair<int,counted> r(std::move(q));
+    no_copies();
+    value_type s(r);
+    if(counted::copies != 1 || s.second.value != 5)
+        fail();
+    counted::copies = counted::moves = 0;
+    std::cout<<c[0]<<std::endl;
+}
+
+void hashmap_tester(){
+    using value_type = sjtu::pair<int,counted>;
+    std::cout<<c[3];
+    sjtu::hashmap<int,counted> map;
+    for(int i=0;i<100;i++)
+        map.insert(value_type(i, counted(i)));
+    no_copies();
+    map.insert(value_type(7, counted(70)));
+    map.emplace(8, counted(80));
+    map.emplace(200, counted(200));
+    map.try_emplace(201, 201);
+    map.try_emplace(7, 700);
+    no_copies();
+    if((*map.find(7)).second.value != 70 || (*map.find(8)).second.value != 80 || (*map.find(201)).second.value != 201)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+void linked_hashmap_tester(){
+    using value_type = sjtu::pair<int,counted>;
+    using mp = sjtu::linked_hashmap<int,counted>;
+    std::cout<<c[4];
+    mp map;
+    for(int i=0;i<100;i++)
+        map.insert(value_type(i, counted(i)));
+    map.insert(value_type(7, counted(70)));
+    map.emplace(8, counted(80));
+    map.try_emplace(101, 101);
+    map.insert_or_assign(9, counted(90));
+    map.insert_or_assign(102, counted(102));
+    // limit reached: the first element's node takes the new one
+    map.insert_or_assign(103, counted(103), map.size());
+    no_copies();
+    if(map.size() != 102 || map.find(0) != map.end())
+        fail();
+    if((*map.find(9)).second.value != 90 || (*map.find(103)).second.value != 103)
+        fail();
+    counted v(5);
+    map.insert_or_assign(10, v);
+    if(counted::copies != 1)
+        fail();
+    counted::copies = counted::moves = 0;
+    std::cout<<c[0]<<std::endl;
+}
+
+void lru_tester(){
+    using value_type = sjtu::pair<const int,counted>;
+    std::cout<<c[5];
+    sjtu::basic_lru<int,counted,std::hash<int>,std::equal_to<int> > tester(10);
+    for(int i=0;i<10;i++)
+        tester.save(value_type(i, counted(i)));
+    no_copies();
+    tester.save(value_type(3, counted(30)));
+    no_copies();
+    // full: 0 goes and its node takes 10
+    tester.save(value_type(10, counted(10)));
+    no_copies();
+    counted *got = tester.get(3);
+    no_copies(false);
+    if(!got || got->value != 30 || tester.get(0))
+        fail();
+    value_type kept(11, counted(11));
+    counted::moves = 0;
+    tester.save(kept);
+    if(counted::copies != 1 || kept.second.value != 11 || tester.get(11)->value != 11)
+        fail();
+    counted::copies = counted::moves = 0;
+    std::cout<<c[0]<<std::endl;
+}
+
+void move_only_tester(){
+    std::cout<<c[6];
+    sjtu::hashmap<int,move_only> map;
+    map.insert(sjtu::pair<int,move_only>(1, move_only(1)));
+    map.emplace(2, move_only(2));
+    map.try_emplace(3, 3);
+    map.insert(sjtu::pair<int,move_only>(1, move_only(10)));
+    if((*map.find(1)).second.value != 10 || (*map.find(3)).second.value != 3)
+        fail();
+
+    sjtu::linked_hashmap<int,move_only> linked;
+    linked.insert(sjtu::pair<int,move_only>(1, move_only(1)));
+    linked.emplace(2, move_only(2));
+    linked.try_emplace(3, 3);
+    linked.insert_or_assign(4, move_only(4));
+    linked.insert_or_assign(5, move_only(5), 4);
+    if(linked.size() != 4 || linked.find(1) != linked.end() || (*linked.find(5)).second.value != 5)
+        fail();
+
+    sjtu::basic_lru<int,move_only,std::hash<int>,std::equal_to<int> > tester(4);
+    for(int i=0;i<8;i++)
+        tester.save(sjtu::pair<const int,move_only>(i, move_only(i)));
+    tester.save(sjtu::pair<const int,move_only>(6, move_only(60)));
+    if(tester.get(3) || !tester.get(6) || tester.get(6)->value != 60 || tester.get(7)->value != 7)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("22.out","w",stdout);
+#endif
+    pair_tester();
+    hashmap_tester();
+    linked_hashmap_tester();
+    lru_tester();
+    move_only_tester();
+    std::cout<<c[7];
+    if(counted::live != 0)
+        fail();
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[8]<<std::endl;
+}
@@ -0,0 +1,146 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+
+// the stats counters on short scripted traces: hits and misses of get
+// and multi_get, saves against updates, evictions (of new keys and of
+// updates that got heavier) with their bytes_evicted, and remove and
+// clear, which count nothing; expands follows the index. built with
+// -DSJTU_NO_STATS every snapshot has to be all zeros instead.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: gets, saves and evictions",
+    "test2: multi_get",
+    "test3: heavier updates evict",
+    "test4: expands, += and hit_ratio",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+struct length_weigher{
+    size_t operator()(int, const std::string &value) const {
+        return value.size();
+    }
+};
+
+/**
+ * s is what the counters should hold, or all zeros without stats
+ */
+void expect(const sjtu::cache_stats &s, uint64_t hits, uint64_t misses, uint64_t saves, uint64_t updates, uint64_t evictions, uint64_t bytes_evicted){
+#ifdef SJTU_NO_STATS
+    hits = misses = saves = updates = evictions = bytes_evicted = 0;
+#endif
+    if(s.hits != hits || s.misses != misses || s.saves != saves || s.updates != updates)
+        fail();
+    if(s.evictions != evictions || s.bytes_evicted != bytes_evicted)
+        fail();
+}
+
+typedef sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int> > int_lru;
+const uint64_t int_bytes = sizeof(sjtu::pair<const int,int>);
+
+void trace_tester(int_lru &tester){
+    using value_type = sjtu::pair<const int,int>;
+    std::cout<<c[2];
+    for(int k=1;k<=3;k++)
+        tester.save(value_type(k,k));
+    expect(tester.stats(), 0, 0, 3, 0, 0, 0);
+    tester.get(1);
+    tester.get(4);
+    expect(tester.stats(), 1, 1, 3, 0, 0, 0);
+    // 2 3 1, then 1 again
+    tester.save(value_type(1,10));
+    expect(tester.stats(), 1, 1, 4, 1, 0, 0);
+    tester.save(value_type(4,4));
+    tester.save(value_type(5,5));
+    expect(tester.stats(), 1, 1, 6, 1, 2, 2*int_bytes);
+    if(tester.get(2) || tester.get(3) || !tester.get(5))
+        fail();
+    expect(tester.stats(), 2, 3, 6, 1, 2, 2*int_bytes);
+    tester.remove(4);
+    tester.save(value_type(6,6));
+    expect(tester.stats(), 2, 3, 7, 1, 2, 2*int_bytes);
+    std::cout<<c[0]<<std::endl;
+}
+
+void multi_get_tester(int_lru &tester){
+    std::cout<<c[3];
+    // 1, 5 and 6 are in
+    const int keys[] = {1, 2, 5, 5, 7, 6};
+    int *out[6];
+    tester.multi_get(keys, 6, out);
+    expect(tester.stats(), 6, 5, 7, 1, 2, 2*int_bytes);
+    tester.clear();
+    tester.get(1);
+    expect(tester.stats(), 6, 6, 7, 1, 2, 2*int_bytes);
+    std::cout<<c[0]<<std::endl;
+}
+
+void heavier_tester(){
+    using value_type = sjtu::pair<const int,std::string>;
+    const uint64_t bytes = sizeof(value_type);
+    std::cout<<c[4];
+    sjtu::basic_lru<int,std::string,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::lru_policy,length_weigher> tester(10);
+    for(int k=0;k<5;k++)
+        tester.save(value_type(k,"ab"));
+    // the weight of 0 goes from 2 to 6: 1 and 2 go
+    tester.save(value_type(0,"abcdef"));
+    expect(tester.stats(), 0, 0, 6, 1, 2, 2*bytes);
+    // one as heavy as c: the other two go
+    tester.save(value_type(9,"abcdefghij"));
+    expect(tester.stats(), 0, 0, 7, 1, 5, 5*bytes);
+    if(tester.map.size() != 1)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+void totals_tester(){
+    using value_type = sjtu::pair<const int,int>;
+    std::cout<<c[5];
+    int_lru tester(100000);
+    size_t expansions = tester.map.expansions();
+    for(int k=0;k<100000;k++)
+        tester.save(value_type(k,k));
+    if(tester.map.expansions() == expansions)
+        fail();
+#ifndef SJTU_NO_STATS
+    if(tester.stats().expands != tester.map.expansions())
+        fail();
+#else
+    if(tester.stats().expands != 0)
+        fail();
+#endif
+    for(int k=0;k<40;k++)
+        tester.get(k%2 ? k : -k-1);
+    sjtu::cache_stats total = tester.stats();
+    total += tester.stats();
+    expect(total, 40, 40, 200000, 0, 0, 0);
+#ifndef SJTU_NO_STATS
+    if(total.hit_ratio() != 0.5)
+        fail();
+#endif
+    if(sjtu::cache_stats().hit_ratio() != 0)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("23.out","w",stdout);
+#endif
+    int_lru tester(3);
+    trace_tester(tester);
+    multi_get_tester(tester);
+    heavier_tester();
+    totals_tester();
+    std::cout<<c[6]<<std::endl;
+}
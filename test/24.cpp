@@ -0,0 +1,147 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <vector>
+
+// multi_get and multi_save against get and save one key at a time:
+// the same trace of batches (1 to 200 keys, so across the 64 of a
+// pipelined batch, with keys repeated within a batch, misses, and
+// saves that evict half way through a batch) goes through one cache
+// batched and through another key by key, for several policies and
+// with weights; every result, the stats and the whole order have to
+// be the same.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: lru_policy",
+    "test2: slru_policy",
+    "test3: tinylfu_policy",
+    "test4: arc_policy",
+    "test5: clock_pro_policy",
+    "test6: s3fifo_policy",
+    "test7: lru_policy with weights",
+    "test8: gdsf_policy with weights",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+struct length_weigher{
+    size_t operator()(int, const std::string &value) const {
+        return value.size();
+    }
+};
+
+int make_value(int, unsigned x){
+    return int(x>>8);
+}
+
+std::string make_string(int, unsigned x){
+    return std::string(1+(x>>8)%20, char('a'+(x>>16)%26));
+}
+
+template<class Cache>
+void same(Cache &batched, Cache &scalar){
+    sjtu::cache_stats a = batched.stats(), b = scalar.stats();
+    if(a.hits != b.hits || a.misses != b.misses || a.saves != b.saves || a.updates != b.updates)
+        fail();
+    if(a.evictions != b.evictions || a.bytes_evicted != b.bytes_evicted || a.expands != b.expands)
+        fail();
+    if(batched.map.size() != scalar.map.size() || batched.weight != scalar.weight)
+        fail();
+    auto it = batched.map.begin();
+    for(auto sit = scalar.map.begin();sit!=scalar.map.end();it++,sit++)
+        if((*it).first != (*sit).first || (*it).second != (*sit).second)
+            fail();
+}
+
+/**
+ * rounds batches on keys [0, keys), now and then on a narrow range so
+ * that a batch repeats its keys
+ */
+template<class Cache, class T>
+void batch_tester(int capacity, int keys, int rounds, T (*make)(int, unsigned)){
+    using value_type = sjtu::pair<const int,T>;
+    Cache batched(capacity), scalar(capacity);
+    unsigned x = 2024;
+    std::vector<int> batch_keys;
+    std::vector<value_type> values;
+    std::vector<T*> out;
+    for(int round=0;round<rounds;round++){
+        x = x*1103515245+12345;
+        size_t n = 1+(x>>8)%200;
+        int range = (x>>4)%4 ? keys : 8;
+        int first = int((x>>16)%unsigned(keys));
+        bool saving = (x>>12)%2;
+        batch_keys.clear();
+        values.clear();
+        for(size_t i=0;i<n;i++){
+            x = x*1103515245+12345;
+            int key = (first+int((x>>8)%unsigned(range)))%keys;
+            batch_keys.push_back(key);
+            if(saving)
+                values.push_back(value_type(key, make(key, x)));
+        }
+        if(saving){
+            batched.multi_save(values.data(), n);
+            for(size_t i=0;i<n;i++)
+                scalar.save(values[i]);
+        }else{
+            out.assign(n, nullptr);
+            batched.multi_get(batch_keys.data(), n, out.data());
+            for(size_t i=0;i<n;i++){
+                T *got = scalar.get(batch_keys[i]);
+                if((got != nullptr) != (out[i] != nullptr) || (got && *got != *out[i]))
+                    fail();
+            }
+        }
+        if(round%10 == 0)
+            same(batched, scalar);
+    }
+    same(batched, scalar);
+    if(batched.stats().evictions == 0 || batched.stats().updates == 0 || batched.stats().misses == 0)
+        fail();
+}
+
+template<class Policy>
+using int_cache = sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,Policy>;
+template<class Policy>
+using string_cache = sjtu::basic_lru<int,std::string,std::hash<int>,std::equal_to<int>,sjtu::chained_table,Policy,length_weigher>;
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("24.out","w",stdout);
+#endif
+    std::cout<<c[2];
+    batch_tester<int_cache<sjtu::lru_policy> >(100, 300, 2000, make_value);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[3];
+    batch_tester<int_cache<sjtu::slru_policy> >(100, 300, 2000, make_value);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[4];
+    batch_tester<int_cache<sjtu::tinylfu_policy> >(100, 300, 2000, make_value);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[5];
+    batch_tester<int_cache<sjtu::arc_policy> >(100, 300, 2000, make_value);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[6];
+    batch_tester<int_cache<sjtu::clock_pro_policy> >(100, 300, 2000, make_value);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[7];
+    batch_tester<int_cache<sjtu::s3fifo_policy> >(100, 300, 2000, make_value);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[8];
+    batch_tester<string_cache<sjtu::lru_policy> >(500, 300, 2000, make_string);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[9];
+    batch_tester<string_cache<sjtu::gdsf_policy> >(500, 300, 2000, make_string);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[10]<<std::endl;
+}
@@ -0,0 +1,179 @@
+#define SJTU_LATENCY
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// latency_histogram with known samples, built with SJTU_LATENCY: the
+// bucket every value lands in (exact below 64, then 32 to a power of
+// two, the last one from 2^40 on) is checked at the edges of every
+// power of two, and the quantiles of random samples from 0 to past
+// 2^40 against a sorted copy of them; quantiles are read back in
+// ticks, so the clock's calibration doesn't matter. then merge and
+// clear, and which histogram of op_latency each operation of a
+// basic_lru goes to.
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: buckets at the powers of two",
+    "test2: quantiles against sorted samples",
+    "test3: merge and clear",
+    "test4: op_latency of a basic_lru",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+/**
+ * the largest value recorded alike with v: v itself below 64, then
+ * the top of v's 1/32 of its power of two, 2^40 - 1 from 2^40 on
+ */
+uint64_t top_of(uint64_t v){
+    const uint64_t limit = uint64_t(1)<<40;
+    if(v >= limit)
+        return limit-1;
+    if(v < 64)
+        return v;
+    uint64_t width = 1;
+    while((v>>5)/width >= 2)
+        width *= 2;
+    return (v/width+1)*width-1;
+}
+
+/**
+ * h.percentile(q) in ticks
+ */
+uint64_t ticks_at(const sjtu::latency_histogram &h, double q){
+    double ticks = h.percentile(q)/sjtu::tick_clock::ns_per_tick();
+    return uint64_t(ticks+0.5);
+}
+
+/**
+ * the q-th quantile of sorted as percentile() ranks it
+ */
+uint64_t expected_at(const std::vector<uint64_t> &sorted, double q){
+    uint64_t rank = uint64_t(q*double(sorted.size())+0.5);
+    rank = rank < 1 ? 1 : rank > sorted.size() ? sorted.size() : rank;
+    return top_of(sorted[rank-1]);
+}
+
+void bucket_tester(){
+    std::cout<<c[2];
+    sjtu::latency_histogram h;
+    if(h.count() != 0 || h.percentile(0.5) != 0)
+        fail();
+    std::vector<uint64_t> values;
+    for(uint64_t v=0;v<70;v++)
+        values.push_back(v);
+    for(unsigned p=6;p<=42;p++){
+        uint64_t power = uint64_t(1)<<p, width = power>>5;
+        for(uint64_t v : {power-1, power, power+1, power+width-1, power+width, 2*power-width, 2*power-2})
+            values.push_back(v);
+    }
+    for(uint64_t v : values){
+        h.clear();
+        h.record(v);
+        uint64_t top = top_of(v);
+        if(h.count() != 1 || ticks_at(h, 0) != top || ticks_at(h, 1) != top)
+            fail();
+        // within 1/32 of v below 2^40
+        if(v < (uint64_t(1)<<40) && (top < v || double(top-v) > double(v)/32))
+            fail();
+    }
+    std::cout<<c[0]<<std::endl;
+}
+
+void quantile_tester(){
+    const double qs[] = {0, 0.001, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 0.9999, 1};
+    std::cout<<c[3];
+    unsigned x = 2024;
+    for(int n : {1, 2, 3, 10, 1000, 100000}){
+        sjtu::latency_histogram h;
+        std::vector<uint64_t> samples;
+        for(int i=0;i<n;i++){
+            x = x*1103515245+12345;
+            unsigned bits = (x>>8)%43;
+            x = x*1103515245+12345;
+            uint64_t r = uint64_t(x>>4)<<28 ^ uint64_t(x*1103515245u+12345u);
+            uint64_t v = bits ? r%(uint64_t(1)<<bits) : 0;
+            samples.push_back(v);
+            h.record(v);
+        }
+        std::sort(samples.begin(), samples.end());
+        if(h.count() != uint64_t(n))
+            fail();
+        for(double q : qs)
+            if(ticks_at(h, q) != expected_at(samples, q))
+                fail();
+    }
+    std::cout<<c[0]<<std::endl;
+}
+
+void merge_tester(){
+    std::cout<<c[4];
+    sjtu::latency_histogram a, b;
+    std::vector<uint64_t> samples;
+    for(uint64_t v=1;v<=300;v++){
+        (v%3 ? a : b).record(v*v);
+        samples.push_back(v*v);
+    }
+    a.merge(b);
+    if(a.count() != 300 || b.count() != 100)
+        fail();
+    for(double q : {0.01, 0.5, 0.9, 1.0})
+        if(ticks_at(a, q) != expected_at(samples, q))
+            fail();
+    a.clear();
+    if(a.count() != 0 || a.percentile(1) != 0)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+void op_latency_tester(){
+    using value_type = sjtu::pair<const int,int>;
+    std::cout<<c[5];
+    sjtu::basic_lru<int,int,std::hash<int>,std::equal_to<int> > tester(1000);
+    for(int k=0;k<500;k++)
+        tester.save(value_type(k,k));
+    for(int k=0;k<100;k++)
+        tester.save(value_type(k,-k));
+    for(int k=0;k<700;k++)
+        tester.get(k);
+    tester.clear();
+    const sjtu::op_latency &l = tester.latency;
+    if(l.get_hit.count() != 500 || l.get_miss.count() != 200 || l.save_update.count() != 100)
+        fail();
+    if(l.save_insert.count() + l.expand.count() != 500 || l.expand.count() == 0 || l.clear_all.count() != 1)
+        fail();
+    std::ostringstream table, json;
+    l.print(table);
+    l.print_json(json);
+    const std::string head = "op count p50 p90 p99 p99.9 p99.99 max\nget_hit 500 ";
+    const std::string json_head = "{\"get_hit\":{\"count\":500,\"p50\":";
+    std::string rows = table.str(), object = json.str();
+    if(std::count(rows.begin(), rows.end(), '\n') != 7 || rows.compare(0, head.size(), head) != 0)
+        fail();
+    if(object.compare(0, json_head.size(), json_head) != 0 || object.back() != '}')
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("25.out","w",stdout);
+#endif
+    bucket_tester();
+    quantile_tester();
+    merge_tester();
+    op_latency_tester();
+    std::cout<<c[6]<<std::endl;
+}
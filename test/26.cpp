@@ -0,0 +1,294 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include "sharded_lru.hpp"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+// sharded_lru with read buffers under 8 threads which get and save
+// the same keys at random while one more keeps calling maintain(),
+// for lru (hits buffered), clock (hits applied under the shared lock)
+// and tinylfu (misses buffered too). a key is only ever saved with
+// the value value_of(key), so any other value read is a torn or freed
+// node; after maintain() the size has to fit the capacity and the
+// hits and misses have to add up to the gets made. the read_buffer
+// on its own: whatever was recorded is drained once, in the order of
+// each thread, and a full ring refuses. and a buffered hit has to be
+// in the order by the next save. then sharded_lru of locked shards:
+// saved in order, every key has to be found exactly when it is one of
+// the last capacity / N (give or take one) keys of the shard its hash
+// sends it to; after 8 threads save and get at once, every shard has
+// to hold its capacity, visit, size and stats have to agree with it,
+// and after clear nothing is left.
+// meant to be run under ThreadSanitizer, and AddressSanitizer:
+//     g++ -std=c++17 -O1 -g -pthread -fsanitize=thread -I../lru 26.cpp
+//     g++ -std=c++17 -O1 -g -pthread -fsanitize=address,undefined -I../lru 26.cpp
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: read_buffer under 8 threads",
+    "test2: a buffered hit is applied before the next save",
+    "test3: buffered lru_policy under 8 threads",
+    "test4: buffered clock_policy under 8 threads",
+    "test5: buffered tinylfu_policy under 8 threads",
+    "test6: routing and capacity of the locked shards",
+    "test7: locked shards after 8 threads save",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void fail(){
+    std::cout<<c[1]<<std::endl;
+    exit(0);
+}
+
+const int threads = 8;
+
+int value_of(int key){
+    return key*7+1;
+}
+
+/**
+ * each thread records its own numbers in order while nobody drains;
+ * every number recorded comes out once, a thread's in its order,
+ * and none that was refused
+ */
+void read_buffer_tester(){
+    const int per_thread = 20000;
+    typedef sjtu::read_buffer<size_t> buffer;
+    std::cout<<c[2];
+    buffer ring;
+    std::vector<std::vector<char> > taken(threads, std::vector<char>(per_thread, 0));
+    std::vector<size_t> last(threads, 0);
+    size_t recorded = 0, drained = 0;
+    for(int round=0;round<20;round++){
+        std::vector<std::thread> workers;
+        std::vector<int> accepted(threads, 0);
+        for(int t=0;t<threads;t++)
+            workers.push_back(std::thread([&, t](){
+                for(int i=round*per_thread/20;i<(round+1)*per_thread/20;i++)
+                    if(ring.record(size_t(t)*per_thread+i+1)){
+                        taken[t][i] = 1;
+                        accepted[t]++;
+                    }
+            }));
+        for(auto &w : workers)
+            w.join();
+        for(int t=0;t<threads;t++)
+            recorded += accepted[t];
+        ring.drain([&](size_t e){
+            int t = int((e-1)/per_thread), i = int((e-1)%per_thread);
+            if(t >= threads || !taken[t][i] || e <= last[t])
+                fail();
+            taken[t][i] = 0;
+            last[t] = e;
+            drained++;
+        });
+    }
+    if(recorded != drained || recorded < buffer::capacity)
+        fail();
+    // one thread has one ring
+    buffer one;
+    for(size_t i=0;i<32;i++)
+        if(!one.record(i))
+            fail();
+    if(one.record(32))
+        fail();
+    one.discard();
+    size_t after = 0;
+    one.drain([&](size_t){ after++; });
+    if(after != 0 || !one.record(0))
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+void drain_tester(){
+    using value_type = sjtu::pair<const int,int>;
+    std::cout<<c[3];
+    sjtu::buffered_lru<int,int,std::hash<int>,std::equal_to<int>,sjtu::chained_table,sjtu::lru_policy> shard;
+    shard.set_capacity(4);
+    for(int k=1;k<=4;k++)
+        shard.save(value_type(k,value_of(k)));
+    int got = 0;
+    if(!shard.visit(1, [&](const int &v){ got = v; }) || got != value_of(1))
+        fail();
+    // 1 was used last: 2 goes
+    shard.save(value_type(5,value_of(5)));
+    if(shard.visit(2, [](const int &){}) || !shard.visit(1, [](const int &){}))
+        fail();
+    shard.visit(3, [](const int &){});
+    shard.maintain();
+    shard.save(value_type(6,value_of(6)));
+    if(shard.visit(4, [](const int &){}) || !shard.visit(3, [](const int &){}) || shard.size() != 4)
+        fail();
+    sjtu::cache_stats s = shard.stats();
+    if(s.hits != 4 || s.misses != 2 || s.saves != 6 || s.evictions != 2)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+/**
+ * rounds of threads doing ops gets and saves each on keys [0, keys),
+ * three in four gets, and one thread calling maintain() until they
+ * are done; checked after every round
+ */
+template<class Cache>
+void threads_tester(int capacity, int keys, int rounds, int ops){
+    using value_type = sjtu::pair<const int,int>;
+    Cache cache(capacity);
+    std::atomic<uint64_t> gets(0), saves(0), wrong(0);
+    for(int round=0;round<rounds;round++){
+        std::atomic<int> running(threads);
+        std::vector<std::thread> workers;
+        for(int t=0;t<threads;t++)
+            workers.push_back(std::thread([&, t](){
+                unsigned x = unsigned(round*threads+t+1);
+                for(int i=0;i<ops;i++){
+                    x = x*1103515245+12345;
+                    int key = int((x>>8)%unsigned(keys));
+                    if((x>>4)%4){
+                        int out = -1;
+                        if(cache.get(key, out) && out != value_of(key))
+                            wrong++;
+                        gets++;
+                    }else{
+                        cache.save(value_type(key,value_of(key)));
+                        saves++;
+                    }
+                }
+                running--;
+            }));
+        std::thread maintainer([&](){
+            while(running.load())
+                cache.maintain();
+        });
+        for(auto &w : workers)
+            w.join();
+        maintainer.join();
+        cache.maintain();
+        if(wrong.load() != 0 || cache.size() > size_t(capacity))
+            fail();
+        sjtu::cache_stats s = cache.stats();
+        if(s.hits+s.misses != gets.load() || s.saves != saves.load() || s.hits == 0 || s.misses == 0)
+            fail();
+    }
+    if(cache.size() == 0)
+        fail();
+}
+
+template<class Policy>
+using buffered = sjtu::sharded_lru<int,int,std::hash<int>,std::equal_to<int>,4,sjtu::chained_table,true,Policy>;
+
+const size_t shards = 8;
+typedef sjtu::sharded_lru<int,int,std::hash<int>,std::equal_to<int>,shards> locked;
+
+/**
+ * the shard key goes to, as sharded_lru picks it
+ */
+size_t shard_of(int key){
+    return (sjtu::mix_hashing::mix(std::hash<int>()(key)) >> 40) & (shards-1);
+}
+
+size_t capacity_of(size_t shard, size_t capacity){
+    return capacity/shards + (shard < capacity%shards ? 1 : 0);
+}
+
+void routing_tester(){
+    using value_type = sjtu::pair<const int,int>;
+    const int keys = 5000;
+    const size_t capacity = 100;
+    std::cout<<c[7];
+    locked cache(capacity);
+    std::vector<std::vector<int> > routed(shards);
+    for(int k=0;k<keys;k++){
+        cache.save(value_type(k,value_of(k)));
+        routed[shard_of(k)].push_back(k);
+    }
+    std::vector<char> expected(keys, 0);
+    for(size_t i=0;i<shards;i++){
+        size_t kept = capacity_of(i, capacity);
+        if(routed[i].size() < kept)
+            fail();
+        for(size_t j=routed[i].size()-kept;j<routed[i].size();j++)
+            expected[routed[i][j]] = 1;
+    }
+    for(int k=0;k<keys;k++){
+        int out = -1;
+        if(cache.get(k, out) != bool(expected[k]) || (expected[k] && out != value_of(k)))
+            fail();
+    }
+    if(cache.size() != capacity)
+        fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+void locked_threads_tester(){
+    using value_type = sjtu::pair<const int,int>;
+    const int per_thread = 3000, keys = threads*per_thread;
+    const size_t capacity = 1000;
+    std::cout<<c[8];
+    locked cache(capacity);
+    std::atomic<uint64_t> wrong(0), gets(0);
+    std::vector<std::thread> workers;
+    for(int t=0;t<threads;t++)
+        workers.push_back(std::thread([&, t](){
+            unsigned x = unsigned(t+1);
+            for(int i=0;i<per_thread;i++){
+                cache.save(value_type(t*per_thread+i,value_of(t*per_thread+i)));
+                x = x*1103515245+12345;
+                int key = int((x>>8)%unsigned(keys));
+                cache.visit(key, [&](const int &v){ if(v != value_of(key)) wrong++; });
+                gets++;
+            }
+        }));
+    for(auto &w : workers)
+        w.join();
+    if(wrong.load() != 0)
+        fail();
+    std::vector<size_t> held(shards, 0);
+    size_t found = 0;
+    for(int k=0;k<keys;k++)
+        if(cache.visit(k, [&](const int &v){ if(v != value_of(k)) wrong++; })){
+            held[shard_of(k)]++;
+            found++;
+        }
+    for(size_t i=0;i<shards;i++)
+        if(held[i] != capacity_of(i, capacity))
+            fail();
+    sjtu::cache_stats s = cache.stats();
+    if(wrong.load() != 0 || found != capacity || cache.size() != capacity)
+        fail();
+    if(s.saves != uint64_t(keys) || s.hits+s.misses != gets.load()+keys || s.evictions != keys-capacity)
+        fail();
+    cache.clear();
+    if(cache.size() != 0)
+        fail();
+    for(int k=0;k<keys;k++)
+        if(cache.visit(k, [](const int &){}))
+            fail();
+    std::cout<<c[0]<<std::endl;
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("26.out","w",stdout);
+#endif
+    read_buffer_tester();
+    drain_tester();
+    std::cout<<c[4];
+    threads_tester<buffered<sjtu::lru_policy> >(256, 1024, 5, 20000);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[5];
+    threads_tester<buffered<sjtu::clock_policy> >(256, 1024, 5, 20000);
+    std::cout<<c[0]<<std::endl;
+    std::cout<<c[6];
+    threads_tester<buffered<sjtu::tinylfu_policy> >(256, 1024, 5, 20000);
+    std::cout<<c[0]<<std::endl;
+    routing_tester();
+    locked_threads_tester();
+    std::cout<<c[9]<<std::endl;
+}